@@ -61,6 +61,14 @@ char* serialize_metadata_to_json(const experiment_metadata_t *metadata) {
     cJSON_AddNumberToObject(root, "msg_size_bytes", metadata->msg_size_bytes);
     cJSON_AddNumberToObject(root, "pop_size", metadata->pop_size);
     cJSON_AddNumberToObject(root, "max_genes", metadata->max_genes);
+    cJSON_AddNumberToObject(root, "num_islands", metadata->num_islands);
+    cJSON_AddNumberToObject(root, "island_migration_interval", metadata->island_migration_interval);
+    cJSON_AddStringToObject(root, "fitness_function", metadata->fitness_function);
+    cJSON_AddNumberToObject(root, "gene_min", metadata->gene_min);
+    cJSON_AddNumberToObject(root, "gene_max", metadata->gene_max);
+    cJSON_AddStringToObject(root, "engine", metadata->engine);
+    cJSON_AddNumberToObject(root, "diversity_collapse", metadata->diversity_collapse);
+    cJSON_AddNumberToObject(root, "resumed_generation", metadata->resumed_generation);
     cJSON_AddNumberToObject(root, "robot_speed", metadata->robot_speed);
     cJSON_AddNumberToObject(root, "experiment_start", (long)(metadata->experiment_start));
     cJSON_AddNumberToObject(root, "experiment_end", (long)(metadata->experiment_end));
@@ -90,13 +98,21 @@ char*  log_experiment_metadata(experiment_metadata_t *metadata) {
     metadata->seed = seed;
     metadata->num_robots = DEFAULT_NUM_ROBOTS;
     metadata->data_link = DEFAULT_DATA_LINK;
-    metadata->routing = DEFAULT_ROUTING;
+    metadata->routing = g_routing == ROUTING_BROADCAST ? "BROADCAST" : "UNICAST";
     metadata->msg_limit = DEFAULT_MSG_LIMIT;
     metadata->com_type = DEFAULT_COM_TYPE;
-    metadata->msg_size_bytes = sizeof(out_message_t);
+    metadata->msg_size_bytes = MIGRATION_FRAME_SIZE(MAX_GENES, GA_QUANTISED_GENES);
     metadata->robot_speed = DEFAULT_ROBOT_SPEED;
-    metadata->pop_size = POP_SIZE;
+    metadata->pop_size = g_pop_size;
     metadata->max_genes = MAX_GENES;
+    metadata->num_islands = g_num_islands;
+    metadata->island_migration_interval = g_island_migration_interval;
+    metadata->fitness_function = (char *)fitness_function;
+    metadata->gene_min = gene_min_value;
+    metadata->gene_max = gene_max_value;
+    metadata->engine = (char *)ga_engine;
+    metadata->diversity_collapse = g_diversity_collapse;
+    metadata->resumed_generation = (int)ga_resumed_generation;
     metadata->experiment_start = experiment_start;
     metadata->experiment_end = experiment_end;
     metadata->experiment_duration = DEFAULT_EXPERIMENT_DURATION;
@@ -13,6 +13,7 @@
 #include <string.h>
 #include <assert.h>
 #include <float.h>
+#include <stdatomic.h>
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -33,8 +34,9 @@
 #include "gui_manager.h"
 #include "data_structures.h"
 #include "ga.h"
+#include "migration_frame.h"
+#include "espnow_peers.h"
 
-#define ESPNOW_MAXDELAY 512
 #define TX_BUDGET   1        
 #define WINDOW_MS   8000
 
@@ -44,42 +46,54 @@ EventGroupHandle_t s_espnow_event_group;
 TaskHandle_t s_espnow_task_handle;
 QueueHandle_t s_example_espnow_queue;
 
-static uint32_t s_peer_start_times[DEFAULT_NUM_ROBOTS] = {0};
-static int8_t s_last_rssi[DEFAULT_NUM_ROBOTS] = {0}; // Track per-robot RSSI
-static uint32_t s_last_latency[DEFAULT_NUM_ROBOTS] = {0}; // Track per-robot latency (ms)
-
-/* Throughput counting variables */
-static uint32_t s_send_bytes = 0;
-static uint32_t s_recv_bytes = 0;
+int g_routing = DEFAULT_ROUTING;    // Read at every push, so it can change between runs.
+
+/* Robots found by discovery beacons, see espnow_peers.h. The table is
+ * changed by espnow_task and the throughput timer and read by the GA
+ * worker's pushes, always under s_peers_lock; the callbacks never touch it. */
+static espnow_peer_table_t s_peers;
+static SemaphoreHandle_t s_peers_lock = NULL;
+static espnow_peer_t s_push_peers[ESPNOW_PEER_MAX];    // espnow_push_best_solution() snapshot
+static const uint8_t s_broadcast_mac[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+// The broadcast peer takes one of the ESP-NOW peer slots
+#define ESPNOW_UNICAST_SLOTS (ESP_NOW_MAX_TOTAL_PEER_NUM - 1)
+
+/* Throughput counting variables, added to by the Wi-Fi task callbacks and
+ * the GA worker's broadcasts, taken and zeroed by the throughput timer */
+static _Atomic uint32_t s_send_bytes = 0;
+static size_t s_out_msg_len = MIGRATION_FRAME_SIZE(MAX_GENES, GA_QUANTISED_GENES); // bytes of the last migration sent
+static _Atomic uint32_t s_recv_bytes = 0;
 static esp_timer_handle_t s_throughput_timer = NULL;
 
+/* Peers announced in the last beacon, kept for a tick the table is busy */
+static int s_beacon_peers = 0;
+
+/* Receive pool drops already reported */
+static uint32_t s_slab_exhausted = 0;
+static uint32_t s_slab_oversize = 0;
+
+/* Callback to espnow_task handoff, see espnow_ring.h */
+static example_espnow_event_t s_send_ring_items[ESPNOW_SEND_RING_SIZE];
+static example_espnow_event_t s_recv_ring_items[ESPNOW_RECV_RING_SIZE];
+static espnow_ring_t s_send_ring;
+static espnow_ring_t s_recv_ring;
+static uint32_t s_send_ring_drops = 0;     // already reported
+static uint32_t s_recv_ring_drops = 0;
+
+/* Migration frames */
+static uint16_t s_migration_seq = 0;
+static uint32_t s_legacy_frames = 0;   // received in the old out_message_t text format
+
 //CPU loggin params
 static TaskStatus_t t[MAX_TASKS];
 static uint32_t prev_idle0 = 0, prev_idle1 = 0;
 
-//THIS NEEDS UPDATING MANUALLY FROM M5CORE2 MAC
-static const uint8_t mac_addresses[DEFAULT_NUM_ROBOTS][ESP_NOW_ETH_ALEN] = {
-    {0x78, 0x21, 0x84, 0x99, 0xDA, 0x8C},
-    {0x78, 0x21, 0x84, 0x93, 0x78, 0xC0},
-//    {0x08, 0xB6, 0x1F, 0x88, 0x20, 0x04},
-//    {0xD4, 0xD4, 0xDA, 0x5C, 0xA9, 0x84},
-//    {0x78, 0x21, 0x84, 0x99, 0xDF, 0x8C},
-//    {0x30, 0xC6, 0xF7, 0x24, 0x92, 0x88},
-//    {0x78, 0x21, 0x84, 0x93, 0x66, 0x9C},
-//    {0x78, 0x21, 0x84, 0x99, 0xDE, 0x6C},
-//    {0xD4, 0xD4, 0xDA, 0x5C, 0xAC, 0x44}, 
-//    {0x30, 0xC6, 0xF7, 0x25, 0xCB, 0xAC}, 
-//    {0x08, 0xB6, 0x1F, 0x88, 0x22, 0x8C}, 
-//    {0xD4, 0xD4, 0xDA, 0x5C, 0xA1, 0x84}, 
-//    {0xD4, 0xD4, 0xDA, 0x5C, 0xB1, 0x9C}
-};
-
-static uint32_t get_max_rand_frequency(void)
+static uint32_t get_max_rand_frequency(const espnow_peer_t *peers, int peer_count)
 {
     uint32_t max = 0;
-    for (int i = 0; i < DEFAULT_NUM_ROBOTS; i++) {
-        if (s_last_latency[i] > max) {
-            max = s_last_latency[i];
+    for (int i = 0; i < peer_count; i++) {
+        if (peers[i].latency_ms > max) {
+            max = peers[i].latency_ms;
         }
     }
     return max;
@@ -101,40 +115,55 @@ static uint32_t get_max_rand_frequency(void)
     }
 #endif
 
-bool validate_mac_addresses_count() {
-    int addresses_count = sizeof(mac_addresses) / sizeof(mac_addresses[0]);
-    if (DEFAULT_NUM_ROBOTS > addresses_count) {
-        ESP_LOGE(TAG, "Not enough MAC addresses (%d available) for %d robots", addresses_count, DEFAULT_NUM_ROBOTS);
+static bool add_espnow_peer(const uint8_t mac[ESP_NOW_ETH_ALEN], void *arg)
+{
+    esp_now_peer_info_t peer = {
+        .channel = CONFIG_ESPNOW_CHANNEL,
+        .ifidx = ESPNOW_WIFI_IF,
+        .encrypt = false,
+    };
+    memcpy(peer.peer_addr, mac, ESP_NOW_ETH_ALEN);
+    esp_err_t err = esp_now_add_peer(&peer);
+    if (err != ESP_OK && err != ESP_ERR_ESPNOW_EXIST) {
+        ESP_LOGE(TAG, "Failed to add peer " MACSTR ": %s", MAC2STR(mac), esp_err_to_name(err));
         return false;
     }
     return true;
 }
 
-static int mac_addr_to_index(const uint8_t mac[ESP_NOW_ETH_ALEN]) {
-    for (int i = 0; i < DEFAULT_NUM_ROBOTS; i++) {
-        if (memcmp(mac_addresses[i], mac, ESP_NOW_ETH_ALEN) == 0) {
-            return i;
-        }
+static void del_espnow_peer(const uint8_t mac[ESP_NOW_ETH_ALEN], void *arg)
+{
+    esp_now_del_peer(mac);
+}
+
+// Any frame from a robot keeps it in the peer table
+static void note_peer_seen(const uint8_t mac[ESP_NOW_ETH_ALEN], int8_t rssi)
+{
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
+    xSemaphoreTake(s_peers_lock, portMAX_DELAY);
+    uint32_t joined = s_peers.stats.joined;
+    espnow_peer_t *peer = espnow_peer_seen(&s_peers, mac, rssi, now_ms);
+    if (s_peers.stats.joined != joined) {
+        ESP_LOGI(TAG, "Discovered robot %s, %d peers", peer->robot_id, s_peers.count);
     }
-    return -1;
+    xSemaphoreGive(s_peers_lock);
 }
 
 // Check if hyper-mutation conditions are met
 static void check_hyper_mutation(void)
 {
     // 1) GA has run at least once
-    // 2) GA not running (ga_ended == true)
+    // 2) GA worker idle (no run in progress or queued)
     // 3) ga_buffer_queue is empty
-    // 4) Only activate once every 3 seconds since ga finishes
-    if (ga_has_run_before && ga_ended) {
+    // 4) Only activate once every 3 seconds since ga finishes, or at once
+    //    if the population has collapsed: rerunning it would not help
+    if (ga_has_run_before && ga_is_idle()) {
         if (uxQueueMessagesWaiting(ga_buffer_queue) == 0) {
             uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
-            if ((now_ms - s_last_ga_time) > 3000) {
+            if ((now_ms - s_last_ga_time) > 3000 || ga_diversity_collapsed()) {
                 //ESP_LOGI(TAG, "Time gap: %lu ms", now_ms - s_last_ga_time);
                 // Restart GA with hyper-mutation
-                activate_hyper_mutation();
-                ga_ended = false;
-                xTaskCreatePinnedToCore(ga_task, "GA Task", 8192, NULL, 3, &ga_task_handle, 1);
+                ga_request_hyper_mutation();
             }
         }
     }
@@ -176,9 +205,51 @@ static void throughput_timer_cb(void *arg)
     //check if ga has gone stagnant
     check_hyper_mutation();
 
-    // Calculate throughput in Kbps (bits/sec ÷ 1000)
-    float kbps_in  = ((float)s_recv_bytes * 8.0f) / 1000.0f;
-    float kbps_out = ((float)s_send_bytes * 8.0f) / 1000.0f;
+    // Calculate throughput in Kbps (bits/sec ÷ 1000), restarting the counts
+    uint32_t recv_bytes = atomic_exchange(&s_recv_bytes, 0);
+    uint32_t send_bytes = atomic_exchange(&s_send_bytes, 0);
+    float kbps_in  = ((float)recv_bytes * 8.0f) / 1000.0f;
+    float kbps_out = ((float)send_bytes * 8.0f) / 1000.0f;
+
+    // Frames the receive callback had to drop since the last tick
+    espnow_slab_stats_t slab;
+    espnow_slab_get_stats(&slab);
+    if (slab.exhausted != s_slab_exhausted || slab.oversize != s_slab_oversize) {
+        ESP_LOGW(TAG, "Receive pool dropped %u frames (no free slot) and %u oversize, %u/%d slots high water",
+                 (unsigned)(slab.exhausted - s_slab_exhausted), (unsigned)(slab.oversize - s_slab_oversize),
+                 (unsigned)slab.high_water, ESPNOW_SLAB_FRAMES);
+        s_slab_exhausted = slab.exhausted;
+        s_slab_oversize = slab.oversize;
+    }
+
+    // Events the callbacks could not hand to espnow_task since the last tick
+    espnow_ring_stats_t send_ring, recv_ring;
+    espnow_ring_get_stats(&s_send_ring, &send_ring);
+    espnow_ring_get_stats(&s_recv_ring, &recv_ring);
+    if (send_ring.drops != s_send_ring_drops || recv_ring.drops != s_recv_ring_drops) {
+        ESP_LOGW(TAG, "Callback rings dropped %u send and %u receive events, high water %u/%u and %u/%u",
+                 (unsigned)(send_ring.drops - s_send_ring_drops), (unsigned)(recv_ring.drops - s_recv_ring_drops),
+                 (unsigned)send_ring.high_water, (unsigned)send_ring.capacity,
+                 (unsigned)recv_ring.high_water, (unsigned)recv_ring.capacity);
+        s_send_ring_drops = send_ring.drops;
+        s_recv_ring_drops = recv_ring.drops;
+    }
+
+    // Discovery: announce ourselves and forget robots that have gone quiet.
+    // This runs on the shared esp_timer task, so it never waits for the
+    // table: if espnow_task or a push holds it, expiry waits a tick.
+    if (xSemaphoreTake(s_peers_lock, 0) == pdTRUE) {
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
+        int evicted = espnow_peers_expire(&s_peers, now_ms, ESPNOW_PEER_TIMEOUT_MS);
+        s_beacon_peers = s_peers.count;
+        xSemaphoreGive(s_peers_lock);
+        if (evicted > 0) {
+            ESP_LOGI(TAG, "%d robots timed out, %d peers", evicted, s_beacon_peers);
+        }
+    }
+    espnow_beacon_t beacon;
+    espnow_beacon_build(&beacon, s_beacon_peers);
+    esp_now_send(s_broadcast_mac, (const uint8_t *)&beacon, sizeof(beacon));
 
     //debug heap
     // ESP_LOGI("HEAP", "free: %u, min-ever: %u",
@@ -186,7 +257,7 @@ static void throughput_timer_cb(void *arg)
     //     (unsigned int) esp_get_minimum_free_heap_size());
 
     // Log only if there’s any incoming/outgoing data
-    if (s_send_bytes != 0 || s_recv_bytes != 0) {
+    if (send_bytes != 0 || recv_bytes != 0) {
         ESP_LOGI(TAG, "Throughput: In=%.2f Kbps, Out=%.2f Kbps", kbps_in, kbps_out);
         // Example: "T|12.34|56.78" T for throughput
         char log_type_buf[32];
@@ -210,7 +281,8 @@ static void throughput_timer_cb(void *arg)
 
         xQueueSend(LogQueue, &log_entry, portMAX_DELAY);
 
-        if (s_recv_bytes != 0) {
+        // Skipped for a tick the peer table is busy, as above
+        if (recv_bytes != 0 && xSemaphoreTake(s_peers_lock, 0) == pdTRUE) {
 
             event_log_t rssi_entry;
 
@@ -219,20 +291,18 @@ static void throughput_timer_cb(void *arg)
             strcpy(rssi_entry.status, "E"); // E for espnow
             strcpy(rssi_entry.tag,    "L"); // L for local
             strcpy(rssi_entry.log_level, "C"); // C for connectivity
-            // Example: "RSSI|<robot0>|<robot1>|<robot2>..."
-            char rssi_buf[128] = "";
-            char *ptr = rssi_buf;
-            uint8_t own_mac[ESP_NOW_ETH_ALEN]; 
-            esp_wifi_get_mac(ESP_IF_WIFI_STA, own_mac);
-            for(int i = 0; i < DEFAULT_NUM_ROBOTS; i++){
-                if (memcmp(mac_addresses[i], own_mac, ESP_NOW_ETH_ALEN) == 0) {
-                    // Leave blank own RSSI
-                    ptr += snprintf(ptr, rssi_buf + sizeof(rssi_buf) - ptr, "|");
-                } else {
-                    // Log RSSI
-                    ptr += snprintf(ptr, rssi_buf + sizeof(rssi_buf) - ptr, "%d|", s_last_rssi[i]);
+            // Example: "<robot_id>:<rssi>|<robot_id>:<rssi>|..." for the
+            // peers discovered, as many as fit the entry
+            char rssi_buf[sizeof(rssi_entry.log_type)] = "";
+            size_t used = 0;
+            for (int i = 0; i < ESPNOW_PEER_TABLE_SIZE && used < sizeof(rssi_buf); i++) {
+                const espnow_peer_t *peer = &s_peers.slots[i];
+                if (peer->used) {
+                    used += snprintf(rssi_buf + used, sizeof(rssi_buf) - used, "%s:%d|",
+                                     peer->robot_id, peer->rssi);
                 }
             }
+            xSemaphoreGive(s_peers_lock);
             strlcpy(rssi_entry.log_type, rssi_buf, sizeof(rssi_entry.log_type));
             strcpy(rssi_entry.from_id, "");
 
@@ -267,15 +337,18 @@ static void throughput_timer_cb(void *arg)
         xQueueSend(LogQueue, &cpu_entry, portMAX_DELAY);
 
     }
-
-    // Reset counters
-    s_send_bytes = 0;
-    s_recv_bytes = 0;
 }
 
 /* ESPNOW sending or receiving callback function is called in WiFi task.
  * Users should not do lengthy operations from this task. Instead, post
- * necessary data to a queue and handle it from a lower priority task. */
+ * necessary data to a ring and wake the lower priority espnow_task. */
+static void wake_espnow_task(void)
+{
+    if (s_espnow_task_handle != NULL) {
+        xTaskNotifyGive(s_espnow_task_handle);
+    }
+}
+
 static void example_espnow_send_cb(const uint8_t *mac_addr, esp_now_send_status_t status)
 {
     example_espnow_event_t evt;
@@ -286,28 +359,21 @@ static void example_espnow_send_cb(const uint8_t *mac_addr, esp_now_send_status_
         return;
     }
 
-    int idx = mac_addr_to_index(mac_addr);
-    if (idx >= 0) {
-        send_cb->start_time_ms = s_peer_start_times[idx];
-        uint32_t ack_time_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
-        uint32_t latency_ms = ack_time_ms - send_cb->start_time_ms;
-        s_last_latency[idx] = latency_ms; // Store last measured latency by mac
-        send_cb->latency_ms = latency_ms;
-    } else {
-        send_cb->start_time_ms = 0;
-        send_cb->latency_ms = 0;
-    }
+    //latency is worked out against the peer table in espnow_task
+    send_cb->ack_time_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
 
     evt.id = EXAMPLE_ESPNOW_SEND_CB;
     memcpy(send_cb->mac_addr, mac_addr, ESP_NOW_ETH_ALEN);
     send_cb->status = status;
 
-    if (xQueueSend(s_example_espnow_queue, &evt, ESPNOW_MAXDELAY) != pdTRUE) {
-        ESP_LOGW(TAG, "Send send queue fail");
+    //never waits on espnow_task, a full ring counts the drop
+    if (espnow_ring_push(&s_send_ring, &evt)) {
+        wake_espnow_task();
     }
 
-    if (status == ESP_NOW_SEND_SUCCESS) {
-        s_send_bytes += sizeof(out_message_t); //For throughput calc
+    //For throughput calc, unicast migrations only: broadcasts are counted when sent
+    if (status == ESP_NOW_SEND_SUCCESS && memcmp(mac_addr, s_broadcast_mac, ESP_NOW_ETH_ALEN) != 0) {
+        atomic_fetch_add(&s_send_bytes, (uint32_t)s_out_msg_len);
     }
 
 }
@@ -327,41 +393,46 @@ static void example_espnow_recv_cb(const esp_now_recv_info_t *recv_info, const u
 
     evt.id = EXAMPLE_ESPNOW_RECV_CB;
     memcpy(recv_cb->mac_addr, mac_addr, ESP_NOW_ETH_ALEN);
-    recv_cb->data = malloc(len);
-    if (recv_cb->data == NULL) {
-        //TODO: Log ERROR RATE?
-        ESP_LOGE(TAG, "Malloc receive data fail");
+    recv_cb->rssi = rssi;
+    //counted by the pool when it is full, reported by throughput_timer_cb
+    recv_cb->frame = espnow_frame_alloc(data, len);
+    if (recv_cb->frame == NULL) {
         return;
     }
 
-    for(int i=0; i<DEFAULT_NUM_ROBOTS; i++){
-        if(memcmp(mac_addresses[i], mac_addr, ESP_NOW_ETH_ALEN) == 0){
-            s_last_rssi[i] = rssi;
-            break;
-        }
+    if (!espnow_beacon_is(data, len)) {
+        atomic_fetch_add(&s_recv_bytes, (uint32_t)len); //For throughput calc
     }
-
-    memcpy(recv_cb->data, data, len);
-    recv_cb->data_len = len;
-    s_recv_bytes += len; //For throughput calc
-    if (xQueueSend(s_example_espnow_queue, &evt, ESPNOW_MAXDELAY) != pdTRUE) {
-        ESP_LOGW(TAG, "Send receive queue fail");
-        free(recv_cb->data);
+    if (espnow_ring_push(&s_recv_ring, &evt)) {
+        wake_espnow_task();
+    } else {
+        espnow_frame_release(recv_cb->frame);
     }
 }
 
-/* Parse received ESPNOW data. */
-static int parse_out_message(const uint8_t *data, int len, out_message_t *msg_out)
+// View of a received migration frame, false if it has to be dropped.
+// The first legacy text message is logged so mixed firmware in a swarm
+// shows up.
+static bool view_migration(const uint8_t *data, int len, migration_frame_view_t *view)
 {
-    if (len != sizeof(out_message_t)) {
-        ESP_LOGE(TAG, "parse_out_message: invalid size. Expected %d, got %d",
-                 (int)sizeof(out_message_t), len);
-        return -1;
+    esp_err_t err = migration_frame_view(data, len, view);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Dropping %d byte migration frame: %s", len, esp_err_to_name(err));
+        return false;
+    }
+    // A robot in broadcast mode may hear its own migration relayed back
+    if (robot_id != NULL && strcmp(view->robot_id, robot_id) == 0) {
+        ESP_LOGD(TAG, "Dropping our own migration frame");
+        return false;
+    }
+    if (view->legacy) {
+        if (s_legacy_frames++ == 0) {
+            ESP_LOGW(TAG, "Robot %s sends the legacy text migration format", view->robot_id);
+        } else {
+            ESP_LOGD(TAG, "Legacy migration message from %s", view->robot_id);
+        }
     }
-    //copy bytes directly into out_message_t
-    memcpy(msg_out, data, sizeof(out_message_t));
-    msg_out->robot_id[sizeof(msg_out->robot_id) - 1] = '\0';
-    return 0;
+    return true;
 }
 
 int example_espnow_data_parse(uint8_t *data, uint16_t data_len, uint8_t *state, uint16_t *seq, uint32_t *magic)
@@ -399,153 +470,140 @@ void espnow_push_best_solution(float current_best_fitness, const float *best_sol
         }
     #endif
 
-    // Prepare the out_message structure
-    out_message_t out_msg;
-    memset(&out_msg, 0, sizeof(out_message_t));
-
-    out_msg.log_id = log_id;
-    out_msg.created_datetime = created_datetime;
-
-    // Use last two MAC bytes to build a 5-digit ID
-    strncpy(out_msg.robot_id, robot_id, sizeof(out_msg.robot_id) - 1);
-    out_msg.robot_id[sizeof(out_msg.robot_id) - 1] = '\0';  //ensure null-termination
-
-    //example: "25.123| 20.111| 35.112| ..."
-    int offset = 0;
-    offset += snprintf(out_msg.message + offset, sizeof(out_msg.message) - offset, "%.3f|", current_best_fitness);
-    for (size_t i = 0; i < gene_count && offset < (int)sizeof(out_msg.message); i++) {
-        offset += snprintf(out_msg.message + offset, sizeof(out_msg.message) - offset, "%.3f|", best_solution[i]);
+    // Binary migration frame, see migration_frame.h
+    migration_frame_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.seq = s_migration_seq++;
+    hdr.flags = GA_QUANTISED_GENES ? MIGRATION_FRAME_QUANTISED : 0;
+    // Last two MAC bytes as the 4-digit robot ID
+    memcpy(hdr.robot_id, robot_id, strnlen(robot_id, sizeof(hdr.robot_id)));
+    hdr.log_id = log_id;
+    hdr.created_datetime = created_datetime;
+    hdr.fitness = current_best_fitness;
+
+    uint8_t out_msg[MIGRATION_FRAME_SIZE(MAX_GENES, GA_QUANTISED_GENES)];
+    size_t msg_len = migration_frame_encode(out_msg, sizeof(out_msg), &hdr, best_solution,
+                                            (int)gene_count, gene_min_value, gene_max_value);
+    if (msg_len == 0) {
+        ESP_LOGE(TAG, "%u genes do not fit a migration frame", (unsigned)gene_count);
+        return;
+    }
+    s_out_msg_len = msg_len;
+
+    // Snapshot of the robots discovered, for shuffling or ranking
+    xSemaphoreTake(s_peers_lock, portMAX_DELAY);
+    int peer_count = espnow_peers_list(&s_peers, s_push_peers, ESPNOW_PEER_MAX);
+    xSemaphoreGive(s_peers_lock);
+    espnow_peer_t *peers = s_push_peers;
+    uint32_t max_rand = get_max_rand_frequency(peers, peer_count);
+
+    // BROADCAST routing: one transmission reaches every robot in range,
+    // whatever the topology. Nothing acknowledges it, so it is counted as
+    // sent here rather than in the send callback.
+    if (g_routing == ROUTING_BROADCAST) {
+        if (DEFAULT_MIGRATION_FREQUENCY == FREQUENCY_RANDOM) {
+            uint32_t delay_ms = (max_rand > 0) ? (esp_random() % max_rand) : 0;
+            vTaskDelay(pdMS_TO_TICKS(delay_ms));
+        }
+        esp_err_t err = esp_now_send(s_broadcast_mac, out_msg, msg_len);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to broadcast best solution: %s", esp_err_to_name(err));
+        } else {
+            atomic_fetch_add(&s_send_bytes, (uint32_t)msg_len);
+            ESP_LOGI(TAG, "Broadcasting best solution to %d peers", peer_count);
+        }
+        return;
     }
-
-    //get own MAC
-    uint8_t own_mac[ESP_NOW_ETH_ALEN];
-    esp_wifi_get_mac(ESP_IF_WIFI_STA, own_mac);
-
-    // Prepare a local copy of mac_addresses for shuffling or ranking if needed
-    uint8_t macs[DEFAULT_NUM_ROBOTS][ESP_NOW_ETH_ALEN];
-    memcpy(macs, mac_addresses, sizeof(macs));
 
     // COMM_AWARE mode: rank peers by latency/RSSI (worst first)
     #if DEFAULT_TOPOLOGY == TOPOLOGY_COMM_AWARE // "COMM_AWARE"
     typedef struct {
-        uint8_t mac[ESP_NOW_ETH_ALEN];
-        int8_t rssi;
-        uint32_t latency;
-        int null_metric; // 1 if rssi or latency is null
+        int null_metric; // 1 if latency is null
         float score; // for sorting
-        int orig_idx;
-    } comm_peer_t;
-    comm_peer_t peers[DEFAULT_NUM_ROBOTS];
-    int peer_count = 0;
-    for (int i = 0; i < DEFAULT_NUM_ROBOTS; i++) {
-        if (memcmp(macs[i], own_mac, ESP_NOW_ETH_ALEN) == 0) continue; // skip self
-        memcpy(peers[peer_count].mac, macs[i], ESP_NOW_ETH_ALEN);
-        peers[peer_count].rssi = s_last_rssi[i];
-        peers[peer_count].latency = s_last_latency[i]; // Use actual last measured latency
-        peers[peer_count].orig_idx = i;
-        // Null if rssi is -128 (never received) or latency is 0 (never sent)
-        peers[peer_count].null_metric = (peers[peer_count].rssi == -128 || peers[peer_count].latency == 0);
-        peer_count++;
+    } comm_rank_t;
+    comm_rank_t ranks[ESPNOW_PEER_MAX];
+    for (int i = 0; i < peer_count; i++) {
+        // Null if latency is 0 (never sent); a discovered peer always has an RSSI
+        ranks[i].null_metric = (peers[i].latency_ms == 0);
     }
     // Normalise and score: higher score = worse
     int8_t min_rssi = 127, max_rssi = -128;
     uint32_t min_lat = UINT32_MAX, max_lat = 0;
     for (int i = 0; i < peer_count; i++) {
-        if (!peers[i].null_metric) {
+        if (!ranks[i].null_metric) {
             if (peers[i].rssi < min_rssi) min_rssi = peers[i].rssi;
             if (peers[i].rssi > max_rssi) max_rssi = peers[i].rssi;
-            if (peers[i].latency < min_lat) min_lat = peers[i].latency;
-            if (peers[i].latency > max_lat) max_lat = peers[i].latency;
+            if (peers[i].latency_ms < min_lat) min_lat = peers[i].latency_ms;
+            if (peers[i].latency_ms > max_lat) max_lat = peers[i].latency_ms;
         }
     }
     for (int i = 0; i < peer_count; i++) {
-        if (peers[i].null_metric) {
-            peers[i].score = 1e6f; // Highest priority
+        if (ranks[i].null_metric) {
+            ranks[i].score = 1e6f; // Highest priority
         } else {
             float norm_rssi = (max_rssi != min_rssi) ? (float)(max_rssi - peers[i].rssi) / (max_rssi - min_rssi) : 0.0f;
-            float norm_lat = (max_lat != min_lat) ? (float)(peers[i].latency - min_lat) / (max_lat - min_lat) : 0.0f;
-            peers[i].score = norm_rssi + norm_lat; // Simple sum, can be weighted
+            float norm_lat = (max_lat != min_lat) ? (float)(peers[i].latency_ms - min_lat) / (max_lat - min_lat) : 0.0f;
+            ranks[i].score = norm_rssi + norm_lat; // Simple sum, can be weighted
         }
     }
     // Sort: null_metric first, then by score descending (worst first)
     for (int i = 0; i < peer_count - 1; i++) {
         for (int j = i + 1; j < peer_count; j++) {
-            if (peers[i].score < peers[j].score) {
-                comm_peer_t tmp = peers[i];
+            if (ranks[i].score < ranks[j].score) {
+                comm_rank_t tmp_rank = ranks[i];
+                ranks[i] = ranks[j];
+                ranks[j] = tmp_rank;
+                espnow_peer_t tmp_peer = peers[i];
                 peers[i] = peers[j];
-                peers[j] = tmp;
+                peers[j] = tmp_peer;
             }
         }
     }
-    // Overwrite macs with sorted order
-    for (int i = 0; i < peer_count; i++) {
-        memcpy(macs[i], peers[i].mac, ESP_NOW_ETH_ALEN);
-    }
     // Only send to top 50% of ranked peers (rounded up)
     int num_targets = peer_count / 2;
     if (num_targets < 1) num_targets = 1;
-    //unicast message to each registered peer except self
-    for (int i = 0; i < num_targets; i++) {
-        if (memcmp(macs[i], own_mac, ESP_NOW_ETH_ALEN) == 0) {
-            continue; // skip sending to self
-        }
-        int idx = peers[i].orig_idx;
-        if (idx >= 0) {
-            uint32_t current_time_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
-            s_peer_start_times[idx] = current_time_ms;
-        }
-        // Random delay
-        if (DEFAULT_MIGRATION_FREQUENCY == FREQUENCY_RANDOM) {
-            uint32_t max_rand = get_max_rand_frequency();
-            uint32_t delay_ms = (max_rand > 0) ? (esp_random() % max_rand) : 0;
-             vTaskDelay(pdMS_TO_TICKS(delay_ms));
-        }
-        esp_err_t err = esp_now_send(macs[i], (uint8_t *)&out_msg, sizeof(out_msg));
-        if (err != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to send best solution to " MACSTR ": %s",
-                MAC2STR(macs[i]), esp_err_to_name(err));
-        } else {
-            ESP_LOGI(TAG, "Sending best solution to " MACSTR, MAC2STR(macs[i]));
-        }
-    }
+    if (num_targets > peer_count) num_targets = peer_count;
 
     #elif DEFAULT_TOPOLOGY == TOPOLOGY_RANDOM // "RANDOM"
     // Fisher-Yates shuffle using esp_random()
-    for (int i = DEFAULT_NUM_ROBOTS - 1; i > 0; i--) {
+    for (int i = peer_count - 1; i > 0; i--) {
         uint32_t r = esp_random() % (i + 1);
-        uint8_t tmp[ESP_NOW_ETH_ALEN];
-        memcpy(tmp, macs[i], ESP_NOW_ETH_ALEN);
-        memcpy(macs[i], macs[r], ESP_NOW_ETH_ALEN);
-        memcpy(macs[r], tmp, ESP_NOW_ETH_ALEN);
-    }
-    //unicast message to each registered peer except self
-    for (int i = 0; i < DEFAULT_NUM_ROBOTS; i++) {
-        if (memcmp(macs[i], own_mac, ESP_NOW_ETH_ALEN) == 0) {
-            continue; // skip sending to self
-        }
-        int idx = mac_addr_to_index(macs[i]);
-        if (idx >= 0) {
-            uint32_t current_time_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
-            s_peer_start_times[idx] = current_time_ms;
+        espnow_peer_t tmp = peers[i];
+        peers[i] = peers[r];
+        peers[r] = tmp;
+    }
+    int num_targets = peer_count;
+    #else
+    int num_targets = 0;
+    #endif
+
+    //unicast message to each chosen peer; we are never in the table
+    for (int i = 0; i < num_targets; i++) {
+        // The peer needs an ESP-NOW slot, and may have timed out since the snapshot
+        uint32_t current_time_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
+        xSemaphoreTake(s_peers_lock, portMAX_DELAY);
+        espnow_peer_t *peer = espnow_peer_find(&s_peers, peers[i].mac);
+        bool registered = peer != NULL && espnow_peer_claim_slot(&s_peers, peer, current_time_ms);
+        xSemaphoreGive(s_peers_lock);
+        if (!registered) {
+            continue;
         }
         // Random delay
         if (DEFAULT_MIGRATION_FREQUENCY == FREQUENCY_RANDOM) {
-            uint32_t max_rand = get_max_rand_frequency();
             uint32_t delay_ms = (max_rand > 0) ? (esp_random() % max_rand) : 0;
              vTaskDelay(pdMS_TO_TICKS(delay_ms));
         }
-        esp_err_t err = esp_now_send(macs[i], (uint8_t *)&out_msg, sizeof(out_msg));
+        esp_err_t err = esp_now_send(peers[i].mac, out_msg, msg_len);
         if (err != ESP_OK) {
             ESP_LOGW(TAG, "Failed to send best solution to " MACSTR ": %s",
-                MAC2STR(macs[i]), esp_err_to_name(err));
+                MAC2STR(peers[i].mac), esp_err_to_name(err));
         } else {
-            ESP_LOGI(TAG, "Sending best solution to " MACSTR, MAC2STR(macs[i]));
+            ESP_LOGI(TAG, "Sending best solution to " MACSTR, MAC2STR(peers[i].mac));
         }
     }
-    #endif
 }
 
-static void log_incoming_buffer_message(const out_message_t *incoming_msg)
+static void log_incoming_buffer_message(const char *from_id)
 {
     event_log_t log_entry;
     time_t now = time(NULL);
@@ -561,7 +619,7 @@ static void log_incoming_buffer_message(const out_message_t *incoming_msg)
     strcpy(log_entry.tag, "R");   // "R" for recieved
     strcpy(log_entry.log_level, "I"); // Info level
     strcpy(log_entry.log_type, "B");  // "B" for buffer
-    strlcpy(log_entry.from_id, incoming_msg->robot_id, sizeof(log_entry.from_id));
+    strlcpy(log_entry.from_id, from_id, sizeof(log_entry.from_id));
 
     xQueueSend(LogQueue, &log_entry, portMAX_DELAY);
 
@@ -598,47 +656,34 @@ static void log_local_evaluation(float remote_best_fitness, float local_best_fit
 void drain_buffered_messages(void)
 {
     example_espnow_event_t tmp_evt;
-    out_message_t incoming_msg;
-    float best_remote_fitness = FLT_MAX;
-    float best_remote_genes[MAX_GENES] = {0};
-    char best_robot_id[sizeof(incoming_msg.robot_id)] = {0};
-    bool candidate_found = false;
+    migration_frame_view_t incoming;
+    // The best frame stays in its receive slot, only its genes are decoded
+    migration_frame_view_t best_remote = {0};
+    espnow_frame_t *best_remote_frame = NULL;
 
     /* Drain all buffered messages in ga_buffer_queue */
     while (xQueueReceive(ga_buffer_queue, &tmp_evt, 0) == pdTRUE) {
         example_espnow_event_recv_cb_t *buffered_recv_cb = &tmp_evt.info.recv_cb;
-        if (parse_out_message(buffered_recv_cb->data, buffered_recv_cb->data_len, &incoming_msg) == 0) {
-            ESP_LOGI(TAG, "Processed buffered message from %s", incoming_msg.robot_id);
-            log_incoming_buffer_message(&incoming_msg);
-
-            // Extract remote fitness and genes:
-            float remote_candidate = 0.0f;
-            float remote_candidate_genes[MAX_GENES] = {0};
-            char msg_copy[sizeof(incoming_msg.message)];
-            strncpy(msg_copy, incoming_msg.message, sizeof(msg_copy));
-            msg_copy[sizeof(msg_copy) - 1] = '\0';
-            char *token = strtok(msg_copy, "|");
-            if (token) {
-                remote_candidate = atof(token); // first token is best fitness
-                int gene_idx = 0;
-                while ((token = strtok(NULL, "|")) != NULL && gene_idx < MAX_GENES) {
-                    remote_candidate_genes[gene_idx++] = atof(token);
-                }
-            }
-            if (remote_candidate < best_remote_fitness) {
-                best_remote_fitness = remote_candidate;
-                memcpy(best_remote_genes, remote_candidate_genes, sizeof(best_remote_genes));
-                strncpy(best_robot_id, incoming_msg.robot_id, sizeof(best_robot_id) - 1);
-                candidate_found = true;
+        espnow_frame_t *frame = buffered_recv_cb->frame;
+        if (view_migration(frame->data, frame->len, &incoming)) {
+            ESP_LOGI(TAG, "Processed buffered message from %s", incoming.robot_id);
+            log_incoming_buffer_message(incoming.robot_id);
+
+            if (best_remote_frame == NULL || incoming.fitness < best_remote.fitness) {
+                espnow_frame_release(best_remote_frame);
+                best_remote = incoming;
+                best_remote_frame = espnow_frame_retain(frame);
             }
         } else {
             ESP_LOGW(TAG, "Failed to parse buffered msg");
         }
-        free(buffered_recv_cb->data);
+        espnow_frame_release(frame);
     }
 
     /* If a better remote candidate is found, integrate it. */
-    if (candidate_found) {
+    if (best_remote_frame != NULL) {
+        float best_remote_fitness = best_remote.fitness;
+        const char *best_robot_id = best_remote.robot_id;
         float local_best_fitness = ((int)(ga_get_local_best_fitness() * 1000)) / 1000.0f;
         if (best_remote_fitness < local_best_fitness) {
 
@@ -646,47 +691,68 @@ void drain_buffered_messages(void)
                      best_remote_fitness, best_robot_id, local_best_fitness);
 
             log_local_evaluation(best_remote_fitness, local_best_fitness, best_robot_id);
-            ga_integrate_remote_solution(best_remote_genes);
-            ga_ended = false;
-            xTaskCreatePinnedToCore(ga_task, "GA Task", 8192, NULL, 3, &ga_task_handle, 1);
+            float best_remote_genes[MAX_GENES];
+            migration_frame_genes(&best_remote, best_remote_genes, MAX_GENES);
+            ga_request_integrate(best_remote_genes);
         } else {
             ESP_LOGW(TAG, "Best buffered remote solution %.3f from %s is not better than local %.3f, ignoring.",
                      best_remote_fitness, best_robot_id, local_best_fitness);
         }
+        espnow_frame_release(best_remote_frame);
+    }
+}
+
+// Next event for espnow_task, a stop ahead of the callbacks' events
+static bool next_event(example_espnow_event_t *evt)
+{
+    return xQueueReceive(s_example_espnow_queue, evt, 0) == pdTRUE ||
+           espnow_ring_pop(&s_send_ring, evt) ||
+           espnow_ring_pop(&s_recv_ring, evt);
+}
+
+void espnow_request_stop(void)
+{
+    if (s_example_espnow_queue == NULL) {
+        ESP_LOGW(TAG, "ESP-NOW not initialised, nothing to stop");
+        return;
     }
+    example_espnow_event_t stop_evt = { .id = EXAMPLE_ESPNOW_STOP };
+    xQueueSend(s_example_espnow_queue, &stop_evt, portMAX_DELAY);
+    wake_espnow_task();
 }
 
 void espnow_task(void *pvParameter)
 {
     example_espnow_event_t evt;
-    out_message_t incoming_msg;
+    migration_frame_view_t incoming;
 
     vTaskDelay(pdMS_TO_TICKS(100));
 
     for (;;) {
 
-        // Block until we receive something from the queue
-        if (xQueueReceive(s_example_espnow_queue, &evt, portMAX_DELAY) != pdTRUE) {
+        // Sleep until a callback or espnow_request_stop() notifies us; a
+        // notification given while we work makes the take return at once
+        if (!next_event(&evt)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
             continue;
         }
         // By default the first message that arrives will be processed.
         switch (evt.id) {
             case EXAMPLE_ESPNOW_STOP:
             {   
-                ga_ended = true;
+                ga_request_stop();
                 
-                    /* ---- wait for GA_COMPLETED_BIT, discarding ESPNOW events -------- */
+                    /* ---- wait for GA_STOPPED_BIT, discarding ESPNOW events -------- */
                     for (;;) {
-                        /* 1.  Is GA finished yet? */
-                        if (xEventGroupGetBits(ga_event_group) & GA_COMPLETED_BIT) {
+                        /* 1.  Has the GA worker exited yet? */
+                        if (xEventGroupGetBits(ga_event_group) & GA_STOPPED_BIT) {
                             break;                             /* done waiting */
                         }
                         /* 2.  Drain anything that may have been queued */
-                        while (xQueueReceive(s_example_espnow_queue, &evt, 0) == pdTRUE) {
-                            /* Free dynamically-allocated buffers to avoid leaks */
-                            if (evt.id == EXAMPLE_ESPNOW_RECV_CB &&
-                                evt.info.recv_cb.data) {
-                                free(evt.info.recv_cb.data);
+                        while (next_event(&evt)) {
+                            /* Hand received frames back to the pool */
+                            if (evt.id == EXAMPLE_ESPNOW_RECV_CB) {
+                                espnow_frame_release(evt.info.recv_cb.frame);
                             }
                         }
                         /* 3.  Sleep a little so we don't burn the CPU */
@@ -701,13 +767,19 @@ void espnow_task(void *pvParameter)
             case EXAMPLE_ESPNOW_RECV_CB:
             {
                 example_espnow_event_recv_cb_t *recv_cb = &evt.info.recv_cb;
+                // Whatever it carries, the frame keeps its sender a peer
+                note_peer_seen(recv_cb->mac_addr, recv_cb->rssi);
+                if (espnow_beacon_is(recv_cb->frame->data, recv_cb->frame->len)) {
+                    espnow_frame_release(recv_cb->frame);
+                    break;
+                }
                 //check if GA is still running
-                if (ga_event_group && !(xEventGroupGetBits(ga_event_group) & GA_COMPLETED_BIT)) {
+                if (ga_event_group && !ga_is_idle()) {
                     ESP_LOGI(TAG, "GA still running; buffering received message.");
                     // Buffer the message for later processing.
                     if (xQueueSend(ga_buffer_queue, &evt, 0) != pdTRUE) {
                         ESP_LOGW(TAG, "Failed to buffer message; dropping it.");
-                        free(recv_cb->data);
+                        espnow_frame_release(recv_cb->frame);
                     }
                     break;
                 } 
@@ -715,8 +787,9 @@ void espnow_task(void *pvParameter)
                 example_espnow_event_t current_evt = evt;
 
                 //Process current message
-                if (parse_out_message(current_evt.info.recv_cb.data, current_evt.info.recv_cb.data_len, &incoming_msg) == 0) {
-                    ESP_LOGI(TAG, "Received message from %s" , incoming_msg.robot_id);
+                espnow_frame_t *frame = current_evt.info.recv_cb.frame;
+                if (view_migration(frame->data, frame->len, &incoming)) {
+                    ESP_LOGI(TAG, "Received message from %s" , incoming.robot_id);
 
                     event_log_t log_entry;
                     time_t now = time(NULL);
@@ -732,27 +805,11 @@ void espnow_task(void *pvParameter)
                     strcpy(log_entry.tag, "M"); // M for message
                     strcpy(log_entry.log_level, "I"); //I for information
                     strcpy(log_entry.log_type, "R"); // R for recieve
-                    strlcpy(log_entry.from_id, incoming_msg.robot_id, sizeof(incoming_msg.robot_id));
+                    strlcpy(log_entry.from_id, incoming.robot_id, sizeof(incoming.robot_id));
                     xQueueSend(LogQueue, &log_entry, portMAX_DELAY);
 
-                    //parse the | delimited message to extract remote_best_fitness and remote genes
-                    //    Example: "25.123| 1.500| 2.300| ..."  
-                    float remote_best_fitness = 0.0f;
-                    float remote_genes[MAX_GENES] = {0};
-
-                    //safely use strtok
-                    char msg_copy[sizeof(incoming_msg.message)];
-                    strncpy(msg_copy, incoming_msg.message, sizeof(msg_copy));
-                    msg_copy[sizeof(msg_copy) - 1] = '\0';
-                    char *token = strtok(msg_copy, "|"); 
-                    if (token) {
-                        remote_best_fitness = atof(token); //first token is the best fitness
-                    }
-                    //subsequent tokens are gene values
-                    int gene_idx = 0;
-                    while ((token = strtok(NULL, "|")) != NULL && gene_idx < MAX_GENES) {
-                        remote_genes[gene_idx++] = atof(token);
-                    }
+                    //the genes are only decoded from the frame if they are wanted
+                    float remote_best_fitness = incoming.fitness;
 
                     //get local fitness for comparison from ga.
                     float local_best_fitness = ((int)(ga_get_local_best_fitness() * 1000)) / 1000.0f;
@@ -761,13 +818,13 @@ void espnow_task(void *pvParameter)
                         ESP_LOGI(TAG, "Remote solution %.3f is better than local %.3f, re-initializing local GA.",
                                 remote_best_fitness, local_best_fitness);
 
-                        log_local_evaluation(remote_best_fitness, local_best_fitness, incoming_msg.robot_id);
+                        log_local_evaluation(remote_best_fitness, local_best_fitness, incoming.robot_id);
+
+                        //integrate and restart on the GA worker
+                        float remote_genes[MAX_GENES];
+                        migration_frame_genes(&incoming, remote_genes, MAX_GENES);
+                        ga_request_integrate(remote_genes);
 
-                        ga_integrate_remote_solution(remote_genes);
-                        //re-init ga_task
-                        ga_ended = false;
-                        xTaskCreatePinnedToCore(ga_task, "GA Task", 8192, NULL, 3, &ga_task_handle, 1);
-                       
                     }
 
                 } else {
@@ -775,7 +832,7 @@ void espnow_task(void *pvParameter)
                 }
 
                 // Cleanup
-                free(current_evt.info.recv_cb.data);
+                espnow_frame_release(frame);
                 break;
             }
 
@@ -783,9 +840,18 @@ void espnow_task(void *pvParameter)
             {
                 example_espnow_event_send_cb_t *send_cb = &evt.info.send_cb;
 
-                // uint32_t ack_time_ms = (uint32_t)(esp_timer_get_time() / 1000ULL);
-                // uint32_t latency_ms = ack_time_ms - send_cb->start_time_ms;
-                uint32_t latency_ms = send_cb->latency_ms;
+                // Broadcasts, beacons or migrations, are not acknowledged and not logged
+                if (memcmp(send_cb->mac_addr, s_broadcast_mac, ESP_NOW_ETH_ALEN) == 0) {
+                    break;
+                }
+                uint32_t latency_ms = 0;
+                xSemaphoreTake(s_peers_lock, portMAX_DELAY);
+                espnow_peer_t *peer = espnow_peer_find(&s_peers, send_cb->mac_addr);
+                if (peer != NULL && peer->last_sent_ms != 0) {
+                    latency_ms = send_cb->ack_time_ms - peer->last_sent_ms;
+                    peer->latency_ms = latency_ms; // Store last measured latency by mac
+                }
+                xSemaphoreGive(s_peers_lock);
 
                 char short_id[5] = {0};  // 2 bytes in hex + 2 digits + null terminator
                 sprintf(short_id, "%02X%02X", send_cb->mac_addr[4], send_cb->mac_addr[5]);
@@ -843,12 +909,31 @@ esp_err_t espnow_init(void)
         return ESP_FAIL;
     }
 
-    ga_buffer_queue = xQueueCreate(25, sizeof(example_espnow_event_t));
+    espnow_slab_init();
+    s_slab_exhausted = 0;
+    s_slab_oversize = 0;
+    espnow_ring_init(&s_send_ring, s_send_ring_items, sizeof(example_espnow_event_t), ESPNOW_SEND_RING_SIZE);
+    espnow_ring_init(&s_recv_ring, s_recv_ring_items, sizeof(example_espnow_event_t), ESPNOW_RECV_RING_SIZE);
+    s_send_ring_drops = 0;
+    s_recv_ring_drops = 0;
+    ga_buffer_queue = xQueueCreate(ESPNOW_BUFFERED_FRAMES, sizeof(example_espnow_event_t));
     if (ga_buffer_queue == NULL) {
         ESP_LOGE(TAG, "Failed to create ga_buffer_queue");
         return ESP_FAIL;
     }
 
+    // Peers are discovered from their beacons, none are known at boot
+    s_peers_lock = xSemaphoreCreateMutex();
+    if (s_peers_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create peer table mutex");
+        return ESP_FAIL;
+    }
+    const espnow_peer_slots_t slots = {
+        .add = add_espnow_peer,
+        .del = del_espnow_peer,
+    };
+    espnow_peers_init(&s_peers, own_mac, ESPNOW_UNICAST_SLOTS, &slots);
+
     //TODO: Currently this does not work as it needs to be on same channel as AP router
     //ESP_ERROR_CHECK( esp_wifi_set_channel(CONFIG_ESPNOW_CHANNEL, WIFI_SECOND_CHAN_NONE));
     //Enable long range
@@ -865,34 +950,15 @@ esp_err_t espnow_init(void)
     ESP_ERROR_CHECK( esp_wifi_connectionless_module_set_wake_interval(CONFIG_ESPNOW_WAKE_INTERVAL) );
     #endif
 
-    /* Add peers: register all other robot MAC addresses */
-    esp_now_peer_info_t *peer = malloc(sizeof(esp_now_peer_info_t));
-    if (peer == NULL) {
-        ESP_LOGE(TAG, "Malloc peer information fail");
+    /* Broadcast peer for the discovery beacons and ROUTING_BROADCAST;
+     * robots get unicast slots as they are sent to, see
+     * espnow_peer_claim_slot() */
+    if (!add_espnow_peer(s_broadcast_mac, NULL)) {
         vSemaphoreDelete(s_example_espnow_queue);
         esp_now_deinit();
         return ESP_FAIL;
     }
 
-    for (int i = 0; i < DEFAULT_NUM_ROBOTS; i++) {
-        if (memcmp(mac_addresses[i], own_mac, ESP_NOW_ETH_ALEN) == 0) {
-            ESP_LOGI("espnow", "Skipping adding self to ESP-NOW peers.");
-            continue;  // Skip adding if the MAC address matches the device's own MAC
-        }
-
-        memset(peer, 0, sizeof(esp_now_peer_info_t));
-        peer->channel = CONFIG_ESPNOW_CHANNEL;
-        peer->ifidx = ESPNOW_WIFI_IF;
-        peer->encrypt = false;
-        memcpy(peer->peer_addr, mac_addresses[i], ESP_NOW_ETH_ALEN); //Register Peer
-        if (esp_now_add_peer(peer) != ESP_OK) {
-            ESP_LOGE("espnow", "Failed to add peer: %02x:%02x:%02x:%02x:%02x:%02x",
-                     mac_addresses[i][0], mac_addresses[i][1], mac_addresses[i][2],
-                     mac_addresses[i][3], mac_addresses[i][4], mac_addresses[i][5]);
-        }
-    }
-    free(peer);
-
     //kpi timer
     const esp_timer_create_args_t throughput_timer_args = {
         .callback = &throughput_timer_cb,
@@ -932,10 +998,9 @@ void espnow_deinit_all(void)
         /* 1.  Drain anything a late ISR / task might still push */
         example_espnow_event_t dummy;
         while (xQueueReceive(s_example_espnow_queue, &dummy, 0) == pdTRUE) {
-            /* If the event contains a malloc-ed buffer, free it here */
-            if (dummy.id == EXAMPLE_ESPNOW_RECV_CB &&
-                dummy.info.recv_cb.data) {
-                free(dummy.info.recv_cb.data);
+            /* Hand received frames back to the pool */
+            if (dummy.id == EXAMPLE_ESPNOW_RECV_CB) {
+                espnow_frame_release(dummy.info.recv_cb.frame);
             }
         }
         /* 2.  Now it is safe to delete the queue handle */
@@ -943,6 +1008,28 @@ void espnow_deinit_all(void)
         s_example_espnow_queue = NULL;
     }
 
+    // Callback events espnow_task did not get to
+    example_espnow_event_t pending;
+    while (espnow_ring_pop(&s_send_ring, &pending)) {
+    }
+    while (espnow_ring_pop(&s_recv_ring, &pending)) {
+        espnow_frame_release(pending.info.recv_cb.frame);
+    }
+
+    // Frames still buffered for the GA go back to the pool too
+    if (ga_buffer_queue) {
+        example_espnow_event_t buffered;
+        while (xQueueReceive(ga_buffer_queue, &buffered, 0) == pdTRUE) {
+            espnow_frame_release(buffered.info.recv_cb.frame);
+        }
+    }
+
+    // esp_now_deinit() dropped every registered peer with it
+    if (s_peers_lock) {
+        vSemaphoreDelete(s_peers_lock);
+        s_peers_lock = NULL;
+    }
+
     // Delete the event group if exists
     if (s_espnow_event_group) {
         vEventGroupDelete(s_espnow_event_group);
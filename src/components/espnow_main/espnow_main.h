@@ -16,6 +16,8 @@ extern "C" {
 
 #include "esp_now.h"
 #include "lvgl.h"
+#include "espnow_slab.h"
+#include "espnow_ring.h"
 
 /* ESPNOW can work in both station and softap mode. It is configured in menuconfig. */
 #if CONFIG_ESPNOW_WIFI_MODE_STATION
@@ -26,7 +28,15 @@ extern "C" {
 #define ESPNOW_WIFI_IF   ESP_IF_WIFI_AP
 #endif
 
-#define ESPNOW_QUEUE_SIZE           6
+#define ESPNOW_QUEUE_SIZE           6   // control events, EXAMPLE_ESPNOW_STOP
+// Callback to espnow_task handoff, one ring per callback type. Powers of
+// two; espnow_ring_bench reports how deep they get under load.
+#define ESPNOW_SEND_RING_SIZE       16
+#define ESPNOW_RECV_RING_SIZE       8
+// Received frames held in ga_buffer_queue while the GA runs. With the
+// receive ring, the frame espnow_task works on and the best buffered one
+// drain_buffered_messages() keeps, every receive slot is accounted for.
+#define ESPNOW_BUFFERED_FRAMES      (ESPNOW_SLAB_FRAMES - ESPNOW_RECV_RING_SIZE - 2)
 #define ESPNOW_COMPLETED_BIT BIT2
 
 #define MAX_TASKS      16        /* > number of tasks in your app   */
@@ -41,10 +51,10 @@ extern QueueHandle_t s_example_espnow_queue;
 
 esp_err_t espnow_init(void);
 void espnow_task(void *pvParameter);
+void espnow_request_stop(void);
 void espnow_push_best_solution(float current_best_fitness, const float *best_solution,
     size_t gene_count, uint32_t log_id, time_t created_datetime);
 void drain_buffered_messages(void);
-bool validate_mac_addresses_count(void);
 void espnow_deinit_all(void);
 
 extern lv_obj_t *espnow_label;
@@ -62,14 +72,13 @@ typedef enum {
 typedef struct {
     uint8_t mac_addr[ESP_NOW_ETH_ALEN];
     esp_now_send_status_t status;
-    uint32_t start_time_ms;
-    uint32_t latency_ms;
+    uint32_t ack_time_ms;                 //Latency is measured from the peer's last_sent_ms
 } example_espnow_event_send_cb_t;
 
 typedef struct {
     uint8_t mac_addr[ESP_NOW_ETH_ALEN];
-    uint8_t *data;
-    int data_len;
+    int8_t rssi;
+    espnow_frame_t *frame;                //Receive pool slot, released by whoever consumes the event.
 } example_espnow_event_recv_cb_t;
 
 typedef union {
@@ -0,0 +1,167 @@
+#include "espnow_peers.h"
+#include <stdio.h>
+#include <string.h>
+
+_Static_assert((ESPNOW_PEER_TABLE_SIZE & (ESPNOW_PEER_TABLE_SIZE - 1)) == 0,
+               "the table is indexed with a mask");
+
+#define TABLE_MASK (ESPNOW_PEER_TABLE_SIZE - 1)
+
+// The first three bytes are the vendor's, the same across a swarm, so the
+// hash takes the last four
+static int home_slot(const uint8_t mac[ESP_NOW_ETH_ALEN])
+{
+    uint32_t low = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) |
+                   ((uint32_t)mac[4] << 8) | mac[5];
+    return (int)((low * 2654435761u) >> 16) & TABLE_MASK;
+}
+
+void espnow_peers_init(espnow_peer_table_t *table, const uint8_t own_mac[ESP_NOW_ETH_ALEN],
+                       int slot_limit, const espnow_peer_slots_t *ops)
+{
+    memset(table, 0, sizeof(*table));
+    memcpy(table->own_mac, own_mac, ESP_NOW_ETH_ALEN);
+    table->slot_limit = slot_limit;
+    table->ops = *ops;
+}
+
+static int find_slot(const espnow_peer_table_t *table, const uint8_t mac[ESP_NOW_ETH_ALEN])
+{
+    for (int i = home_slot(mac);; i = (i + 1) & TABLE_MASK) {
+        if (!table->slots[i].used) {
+            return -1;
+        }
+        if (memcmp(table->slots[i].mac, mac, ESP_NOW_ETH_ALEN) == 0) {
+            return i;
+        }
+    }
+}
+
+espnow_peer_t *espnow_peer_find(espnow_peer_table_t *table, const uint8_t mac[ESP_NOW_ETH_ALEN])
+{
+    int i = find_slot(table, mac);
+    return i < 0 ? NULL : &table->slots[i];
+}
+
+espnow_peer_t *espnow_peer_seen(espnow_peer_table_t *table, const uint8_t mac[ESP_NOW_ETH_ALEN],
+                                int8_t rssi, uint32_t now_ms)
+{
+    if (memcmp(mac, table->own_mac, ESP_NOW_ETH_ALEN) == 0) {
+        return NULL;
+    }
+
+    int i = home_slot(mac);
+    while (table->slots[i].used && memcmp(table->slots[i].mac, mac, ESP_NOW_ETH_ALEN) != 0) {
+        i = (i + 1) & TABLE_MASK;
+    }
+    espnow_peer_t *peer = &table->slots[i];
+    if (!peer->used) {
+        if (table->count >= ESPNOW_PEER_MAX) {
+            table->stats.refused++;
+            return NULL;
+        }
+        memset(peer, 0, sizeof(*peer));
+        memcpy(peer->mac, mac, ESP_NOW_ETH_ALEN);
+        snprintf(peer->robot_id, sizeof(peer->robot_id), "%02X%02X", mac[4], mac[5]);
+        peer->used = true;
+        table->count++;
+        table->stats.joined++;
+    }
+    peer->rssi = rssi;
+    peer->last_seen_ms = now_ms;
+    return peer;
+}
+
+static void release_slot(espnow_peer_table_t *table, espnow_peer_t *peer)
+{
+    if (peer->registered) {
+        table->ops.del(peer->mac, table->ops.arg);
+        peer->registered = false;
+        table->registered--;
+    }
+}
+
+// Backward shift: entries after the hole that may sit in it move up, so
+// no probe sequence is broken and no tombstones build up
+static void remove_slot(espnow_peer_table_t *table, int hole)
+{
+    table->slots[hole].used = false;
+    table->count--;
+    for (int j = (hole + 1) & TABLE_MASK; table->slots[j].used; j = (j + 1) & TABLE_MASK) {
+        int home = home_slot(table->slots[j].mac);
+        // Moves if its home is not cyclically within (hole, j]
+        if (((j - home) & TABLE_MASK) >= ((j - hole) & TABLE_MASK)) {
+            table->slots[hole] = table->slots[j];
+            table->slots[j].used = false;
+            hole = j;
+        }
+    }
+}
+
+int espnow_peers_expire(espnow_peer_table_t *table, uint32_t now_ms, uint32_t timeout_ms)
+{
+    int evicted = 0;
+    for (int i = 0; i < ESPNOW_PEER_TABLE_SIZE; i++) {
+        // A shift can bring another stale peer into i, so look again
+        while (table->slots[i].used && now_ms - table->slots[i].last_seen_ms > timeout_ms) {
+            release_slot(table, &table->slots[i]);
+            remove_slot(table, i);
+            evicted++;
+        }
+    }
+    table->stats.evicted += evicted;
+    return evicted;
+}
+
+bool espnow_peer_claim_slot(espnow_peer_table_t *table, espnow_peer_t *peer, uint32_t now_ms)
+{
+    if (!peer->registered) {
+        if (table->registered >= table->slot_limit) {
+            espnow_peer_t *oldest = NULL;
+            for (int i = 0; i < ESPNOW_PEER_TABLE_SIZE; i++) {
+                espnow_peer_t *p = &table->slots[i];
+                if (p->used && p->registered &&
+                    (oldest == NULL || now_ms - p->last_sent_ms > now_ms - oldest->last_sent_ms)) {
+                    oldest = p;
+                }
+            }
+            if (oldest == NULL) {
+                return false;
+            }
+            release_slot(table, oldest);
+            table->stats.rotations++;
+        }
+        if (!table->ops.add(peer->mac, table->ops.arg)) {
+            return false;
+        }
+        peer->registered = true;
+        table->registered++;
+    }
+    peer->last_sent_ms = now_ms;
+    return true;
+}
+
+int espnow_peers_list(const espnow_peer_table_t *table, espnow_peer_t *out, int max)
+{
+    int n = 0;
+    for (int i = 0; i < ESPNOW_PEER_TABLE_SIZE && n < max; i++) {
+        if (table->slots[i].used) {
+            out[n++] = table->slots[i];
+        }
+    }
+    return n;
+}
+
+void espnow_beacon_build(espnow_beacon_t *beacon, int peers)
+{
+    beacon->magic[0] = ESPNOW_BEACON_MAGIC0;
+    beacon->magic[1] = ESPNOW_BEACON_MAGIC1;
+    beacon->version = ESPNOW_BEACON_VERSION;
+    beacon->peers = (uint8_t)(peers > UINT8_MAX ? UINT8_MAX : peers);
+}
+
+bool espnow_beacon_is(const uint8_t *data, int len)
+{
+    return len == (int)sizeof(espnow_beacon_t) && data[0] == ESPNOW_BEACON_MAGIC0 &&
+           data[1] == ESPNOW_BEACON_MAGIC1 && data[2] == ESPNOW_BEACON_VERSION;
+}
@@ -0,0 +1,102 @@
+#ifndef ESPNOW_PEERS_H
+#define ESPNOW_PEERS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_now.h"
+
+// Table of the robots heard from, filled by discovery beacons.
+//
+// Every robot broadcasts an espnow_beacon_t once a second; any frame from
+// a robot, beacon or migration, adds it to the table or refreshes its
+// last-seen time, and a robot not heard from for ESPNOW_PEER_TIMEOUT_MS is
+// evicted. The table is open addressed on a hash of the MAC, probed
+// linearly and deleted by backward shift, so lookups from the send and
+// receive paths cost one or two probes whatever the swarm size.
+//
+// ESP-NOW registers a limited number of unicast peers. A peer claims a
+// slot before it is sent to; with every slot taken, the one sent to least
+// recently gives its slot up, so a swarm larger than the hardware limit
+// rotates through it. Registering and unregistering go through the
+// espnow_peer_slots_t callbacks, esp_now_add_peer() and esp_now_del_peer()
+// on the robot.
+//
+// The table does no locking of its own.
+#define ESPNOW_PEER_TABLE_SIZE      128     // power of two
+#define ESPNOW_PEER_MAX             (ESPNOW_PEER_TABLE_SIZE / 2)   // keeps probes short
+#define ESPNOW_PEER_TIMEOUT_MS      10000   // ten missed beacons
+#define ESPNOW_BEACON_INTERVAL_MS   1000
+
+#define ESPNOW_BEACON_MAGIC0        'B'
+#define ESPNOW_BEACON_MAGIC1        'C'
+#define ESPNOW_BEACON_VERSION       1
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic[2];
+    uint8_t version;
+    uint8_t peers;              // table size of the sender, for the logs
+} espnow_beacon_t;
+
+typedef struct {
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    bool used;
+    bool registered;            // holds an ESP-NOW peer slot
+    char robot_id[5];           // last two MAC bytes in hex
+    int8_t rssi;                // of the last frame received
+    uint32_t last_seen_ms;
+    uint32_t last_sent_ms;      // start of the last unicast, 0 before any
+    uint32_t latency_ms;        // last send to its ack, 0 before any
+} espnow_peer_t;
+
+typedef struct {
+    bool (*add)(const uint8_t mac[ESP_NOW_ETH_ALEN], void *arg);
+    void (*del)(const uint8_t mac[ESP_NOW_ETH_ALEN], void *arg);
+    void *arg;
+} espnow_peer_slots_t;
+
+typedef struct {
+    uint32_t joined;
+    uint32_t evicted;           // timed out
+    uint32_t refused;           // new robots with the table full
+    uint32_t rotations;         // slots taken from one peer for another
+} espnow_peer_stats_t;
+
+typedef struct {
+    espnow_peer_t slots[ESPNOW_PEER_TABLE_SIZE];
+    int count;
+    int registered;
+    int slot_limit;
+    uint8_t own_mac[ESP_NOW_ETH_ALEN];
+    espnow_peer_slots_t ops;
+    espnow_peer_stats_t stats;
+} espnow_peer_table_t;
+
+void espnow_peers_init(espnow_peer_table_t *table, const uint8_t own_mac[ESP_NOW_ETH_ALEN],
+                       int slot_limit, const espnow_peer_slots_t *ops);
+espnow_peer_t *espnow_peer_find(espnow_peer_table_t *table, const uint8_t mac[ESP_NOW_ETH_ALEN]);
+// Adds or refreshes the robot a frame came from. NULL for our own MAC or
+// a new robot with the table full.
+espnow_peer_t *espnow_peer_seen(espnow_peer_table_t *table, const uint8_t mac[ESP_NOW_ETH_ALEN],
+                                int8_t rssi, uint32_t now_ms);
+// Evicts peers not seen for timeout_ms, giving up their slots. Returns how
+// many went.
+int espnow_peers_expire(espnow_peer_table_t *table, uint32_t now_ms, uint32_t timeout_ms);
+// Registers peer with ESP-NOW before a unicast, rotating out the least
+// recently sent to peer if every slot is taken, and stamps last_sent_ms.
+// False if the peer could not be registered.
+bool espnow_peer_claim_slot(espnow_peer_table_t *table, espnow_peer_t *peer, uint32_t now_ms);
+// Copies the peers out, in table order, up to max of them
+int espnow_peers_list(const espnow_peer_table_t *table, espnow_peer_t *out, int max);
+
+void espnow_beacon_build(espnow_beacon_t *beacon, int peers);
+bool espnow_beacon_is(const uint8_t *data, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPNOW_PEERS_H
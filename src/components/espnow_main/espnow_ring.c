@@ -0,0 +1,56 @@
+#include "espnow_ring.h"
+#include <string.h>
+
+void espnow_ring_init(espnow_ring_t *ring, void *storage, size_t item_size, uint32_t capacity)
+{
+    ring->items = storage;
+    ring->item_size = item_size;
+    ring->mask = capacity - 1;
+    atomic_store(&ring->head, 0);
+    atomic_store(&ring->tail, 0);
+    atomic_store(&ring->pushed, 0);
+    atomic_store(&ring->drops, 0);
+    atomic_store(&ring->high_water, 0);
+}
+
+bool espnow_ring_push(espnow_ring_t *ring, const void *item)
+{
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    unsigned int waiting = head - tail;
+    if (waiting > ring->mask) {
+        atomic_fetch_add_explicit(&ring->drops, 1, memory_order_relaxed);
+        return false;
+    }
+    memcpy(ring->items + (size_t)(head & ring->mask) * ring->item_size, item, ring->item_size);
+    // Publishes the item to the consumer
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&ring->pushed, 1, memory_order_relaxed);
+    if (waiting + 1 > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, waiting + 1, memory_order_relaxed);
+    }
+    return true;
+}
+
+bool espnow_ring_pop(espnow_ring_t *ring, void *item)
+{
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    memcpy(item, ring->items + (size_t)(tail & ring->mask) * ring->item_size, ring->item_size);
+    // Hands the slot back to the producer
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+void espnow_ring_get_stats(espnow_ring_t *ring, espnow_ring_stats_t *stats)
+{
+    stats->capacity = ring->mask + 1;
+    stats->pushed = atomic_load(&ring->pushed);
+    stats->drops = atomic_load(&ring->drops);
+    stats->waiting = atomic_load(&ring->head) - atomic_load(&ring->tail);
+    stats->high_water = atomic_load(&ring->high_water);
+}
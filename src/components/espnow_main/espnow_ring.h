@@ -0,0 +1,50 @@
+#ifndef ESPNOW_RING_H
+#define ESPNOW_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Single-producer, single-consumer ring of fixed size items.
+//
+// The ESP-NOW callbacks run in the Wi-Fi task and must never wait on
+// espnow_task: each callback type pushes into its own ring, which is
+// lock-free and refuses rather than blocks when full, then wakes the task
+// with a notification. Only the producer moves head and only the consumer
+// moves tail, both free running, so neither side takes a lock. The
+// capacity must be a power of two.
+typedef struct {
+    uint8_t *items;
+    size_t item_size;
+    uint32_t mask;              // capacity - 1
+    atomic_uint head;           // next slot written, producer only
+    atomic_uint tail;           // next slot read, consumer only
+    atomic_uint pushed;
+    atomic_uint drops;          // pushes refused with the ring full
+    atomic_uint high_water;     // most items ever waiting
+} espnow_ring_t;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t pushed;
+    uint32_t drops;
+    uint32_t waiting;
+    uint32_t high_water;
+} espnow_ring_stats_t;
+
+// storage holds capacity items of item_size bytes
+void espnow_ring_init(espnow_ring_t *ring, void *storage, size_t item_size, uint32_t capacity);
+bool espnow_ring_push(espnow_ring_t *ring, const void *item);   // producer, false if full
+bool espnow_ring_pop(espnow_ring_t *ring, void *item);          // consumer, false if empty
+void espnow_ring_get_stats(espnow_ring_t *ring, espnow_ring_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPNOW_RING_H
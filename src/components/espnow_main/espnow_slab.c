@@ -0,0 +1,89 @@
+#include "espnow_slab.h"
+#include <string.h>
+
+_Static_assert(ESPNOW_SLAB_FRAMES <= 32, "the free slots are one 32-bit bitmap");
+
+static espnow_frame_t s_frames[ESPNOW_SLAB_FRAMES];    // .bss, internal RAM
+static atomic_uint s_free;                              // bit per free slot
+
+static atomic_uint s_allocs;
+static atomic_uint s_exhausted;
+static atomic_uint s_oversize;
+static atomic_uint s_high_water;
+
+void espnow_slab_init(void)
+{
+    for (int i = 0; i < ESPNOW_SLAB_FRAMES; i++) {
+        atomic_store(&s_frames[i].refs, 0);
+    }
+    atomic_store(&s_free, ESPNOW_SLAB_FRAMES == 32 ? UINT32_MAX : (1u << ESPNOW_SLAB_FRAMES) - 1);
+    atomic_store(&s_allocs, 0);
+    atomic_store(&s_exhausted, 0);
+    atomic_store(&s_oversize, 0);
+    atomic_store(&s_high_water, 0);
+}
+
+espnow_frame_t *espnow_frame_alloc(const uint8_t *data, int len)
+{
+    if (len < 0 || len > (int)ESPNOW_SLAB_FRAME_BYTES) {
+        atomic_fetch_add(&s_oversize, 1);
+        return NULL;
+    }
+
+    unsigned int free_mask = atomic_load_explicit(&s_free, memory_order_relaxed);
+    unsigned int taken;
+    int slot;
+    do {
+        if (free_mask == 0) {
+            atomic_fetch_add_explicit(&s_exhausted, 1, memory_order_relaxed);
+            return NULL;
+        }
+        slot = __builtin_ctz(free_mask);
+        taken = free_mask & ~(1u << slot);
+    } while (!atomic_compare_exchange_weak_explicit(&s_free, &free_mask, taken,
+                                                    memory_order_acquire, memory_order_relaxed));
+
+    // The slot is ours alone until the handle is queued, which publishes it
+    espnow_frame_t *frame = &s_frames[slot];
+    memcpy(frame->data, data, len);
+    frame->len = (uint16_t)len;
+    atomic_store_explicit(&frame->refs, 1, memory_order_relaxed);
+
+    atomic_fetch_add_explicit(&s_allocs, 1, memory_order_relaxed);
+    unsigned int in_use = ESPNOW_SLAB_FRAMES - __builtin_popcount(taken);
+    unsigned int high = atomic_load_explicit(&s_high_water, memory_order_relaxed);
+    while (in_use > high && !atomic_compare_exchange_weak_explicit(&s_high_water, &high, in_use,
+                                                                   memory_order_relaxed,
+                                                                   memory_order_relaxed)) {
+    }
+    return frame;
+}
+
+espnow_frame_t *espnow_frame_retain(espnow_frame_t *frame)
+{
+    atomic_fetch_add_explicit(&frame->refs, 1, memory_order_relaxed);
+    return frame;
+}
+
+void espnow_frame_release(espnow_frame_t *frame)
+{
+    if (frame == NULL) {
+        return;
+    }
+    // A sole holder is the only one who could add a reference, so it can
+    // skip the decrement, the usual case of one consumer per frame
+    if (atomic_load_explicit(&frame->refs, memory_order_acquire) == 1 ||
+        atomic_fetch_sub_explicit(&frame->refs, 1, memory_order_acq_rel) == 1) {
+        atomic_store_explicit(&frame->refs, 0, memory_order_relaxed);
+        atomic_fetch_or_explicit(&s_free, 1u << (frame - s_frames), memory_order_release);
+    }
+}
+
+void espnow_slab_get_stats(espnow_slab_stats_t *stats)
+{
+    stats->allocs = atomic_load(&s_allocs);
+    stats->exhausted = atomic_load(&s_exhausted);
+    stats->oversize = atomic_load(&s_oversize);
+    stats->in_use = ESPNOW_SLAB_FRAMES - __builtin_popcount(atomic_load(&s_free));
+    stats->high_water = atomic_load(&s_high_water);
+}
@@ -0,0 +1,58 @@
+#ifndef ESPNOW_SLAB_H
+#define ESPNOW_SLAB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "data_structures.h"
+#include "globals.h"
+
+// Fixed pool of receive buffers for ESP-NOW frames.
+//
+// The receive callback runs in the Wi-Fi task, so rather than malloc() a
+// copy of every frame it takes a slot from a static pool in internal RAM
+// and passes the handle on through the receive ring and
+// ga_buffer_queue. Handles are reference counted: whoever holds one
+// releases it once, espnow_frame_retain() adds a holder, and the slot
+// goes back to the pool with the last release. Allocation and release are
+// lock-free, a CAS on a bitmap of the free slots, and never block the
+// Wi-Fi task. A frame arriving with every slot in use is dropped and
+// counted rather than waiting.
+//
+// A slot holds the largest migration message, a raw MAX_GENES frame or a
+// legacy out_message_t; anything longer is not ours and is dropped too.
+#define ESPNOW_SLAB_FRAMES 32   // at most 32, the free bitmap is a word
+#define ESPNOW_SLAB_FRAME_BYTES                                                 \
+    (MIGRATION_FRAME_SIZE(MAX_GENES, 0) > sizeof(out_message_t)                \
+         ? MIGRATION_FRAME_SIZE(MAX_GENES, 0) : sizeof(out_message_t))
+
+typedef struct {
+    atomic_uint refs;           // holders, 0 while in the pool
+    uint16_t len;
+    uint8_t data[ESPNOW_SLAB_FRAME_BYTES];
+} espnow_frame_t;
+
+typedef struct {
+    uint32_t allocs;
+    uint32_t exhausted;         // frames dropped with every slot in use
+    uint32_t oversize;          // frames dropped for being over a slot
+    uint32_t in_use;
+    uint32_t high_water;        // most slots ever in use at once
+} espnow_slab_stats_t;
+
+void espnow_slab_init(void);    // every slot free, counters zeroed
+// Copies len bytes into a free slot, holding one reference. NULL, and
+// counted, if the pool is exhausted or len is over a slot.
+espnow_frame_t *espnow_frame_alloc(const uint8_t *data, int len);
+espnow_frame_t *espnow_frame_retain(espnow_frame_t *frame);
+void espnow_frame_release(espnow_frame_t *frame);   // NULL is ignored
+void espnow_slab_get_stats(espnow_slab_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESPNOW_SLAB_H
@@ -0,0 +1,187 @@
+#include "migration_frame.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_crc.h"
+#include "esp_now.h"
+#include "ga.h"
+
+#define MIGRATION_FRAME_CRC_BYTES sizeof(uint32_t)
+
+// Gene codes as ga_gene_quantise() and ga_gene_dequantise() compute them,
+// so a quantised GA gets back exactly the codes its peer sent
+static inline float geneMid(float gene_min, float gene_max)
+{
+    return 0.5f * (gene_min + gene_max);
+}
+
+static inline float geneStep(float gene_min, float gene_max)
+{
+    return (gene_max - gene_min) / (2.0f * GA_GENE_QMAX);
+}
+
+size_t migration_frame_encode(uint8_t *buf, size_t cap, const migration_frame_header_t *hdr,
+                              const float *genes, int gene_count, float gene_min, float gene_max)
+{
+    bool quantised = (hdr->flags & MIGRATION_FRAME_QUANTISED) != 0;
+    if (gene_count < 0 || gene_count > UINT8_MAX) {
+        return 0;
+    }
+    size_t len = MIGRATION_FRAME_SIZE((size_t)gene_count, quantised);
+    if (len > cap || len > ESP_NOW_MAX_DATA_LEN) {
+        return 0;
+    }
+
+    migration_frame_header_t out = *hdr;
+    out.magic[0] = MIGRATION_FRAME_MAGIC0;
+    out.magic[1] = MIGRATION_FRAME_MAGIC1;
+    out.version = MIGRATION_FRAME_VERSION;
+    out.gene_count = (uint8_t)gene_count;
+    out.reserved = 0;
+    memcpy(buf, &out, sizeof(out));
+
+    uint8_t *p = buf + sizeof(out);
+    if (quantised) {
+        float mid = geneMid(gene_min, gene_max);
+        float inv_step = 1.0f / geneStep(gene_min, gene_max);
+        memcpy(p, &gene_min, sizeof(float));
+        memcpy(p + sizeof(float), &gene_max, sizeof(float));
+        p += 2 * sizeof(float);
+        for (int i = 0; i < gene_count; i++) {
+            float q = (genes[i] - mid) * inv_step;
+            if (q > GA_GENE_QMAX) q = GA_GENE_QMAX;
+            if (q < -GA_GENE_QMAX) q = -GA_GENE_QMAX;
+            int16_t code = (int16_t)lrintf(q);
+            memcpy(p, &code, sizeof(code));
+            p += sizeof(code);
+        }
+    } else {
+        memcpy(p, genes, gene_count * sizeof(float));
+        p += gene_count * sizeof(float);
+    }
+
+    uint32_t crc = esp_crc32_le(0, buf, (uint32_t)(p - buf));
+    memcpy(p, &crc, sizeof(crc));
+    return len;
+}
+
+// An out_message_t of older firmware: its text is NUL terminated inside
+// the frame and holds nothing but numbers, '|' and the 'Q' hex genes
+static bool isLegacyMessage(const uint8_t *data, size_t len)
+{
+    size_t start = offsetof(out_message_t, message);
+    if (len <= start || len > sizeof(out_message_t)) {
+        return false;
+    }
+    const char *text = (const char *)data + start;
+    size_t text_len = strnlen(text, len - start);
+    if (text_len == 0 || text_len == len - start) {
+        return false;
+    }
+    return strspn(text, "0123456789abcdefABCDEF.|+- Q") == text_len;
+}
+
+static esp_err_t viewLegacy(const uint8_t *data, migration_frame_view_t *view)
+{
+    out_message_t msg;
+    memcpy(&msg, data, offsetof(out_message_t, message));
+    view->legacy = true;
+    view->seq = 0;
+    view->log_id = msg.log_id;
+    view->gene_count = -1;
+    memcpy(view->robot_id, msg.robot_id, sizeof(view->robot_id) - 1);
+    view->robot_id[sizeof(view->robot_id) - 1] = '\0';
+    //first token is the best fitness, strtof stops at the '|'
+    view->fitness = strtof((const char *)data + offsetof(out_message_t, message), NULL);
+    return ESP_OK;
+}
+
+esp_err_t migration_frame_view(const uint8_t *data, size_t len, migration_frame_view_t *view)
+{
+    memset(view, 0, sizeof(*view));
+    view->data = data;
+    view->len = len;
+
+    const migration_frame_header_t *hdr = (const migration_frame_header_t *)data;
+    if (len < sizeof(*hdr) + MIGRATION_FRAME_CRC_BYTES ||
+        hdr->magic[0] != MIGRATION_FRAME_MAGIC0 || hdr->magic[1] != MIGRATION_FRAME_MAGIC1) {
+        return isLegacyMessage(data, len) ? viewLegacy(data, view) : ESP_ERR_INVALID_ARG;
+    }
+    if (hdr->version != MIGRATION_FRAME_VERSION) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (len != MIGRATION_FRAME_SIZE(hdr->gene_count, hdr->flags & MIGRATION_FRAME_QUANTISED)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint32_t crc;
+    memcpy(&crc, data + len - MIGRATION_FRAME_CRC_BYTES, sizeof(crc));
+    if (esp_crc32_le(0, data, (uint32_t)(len - MIGRATION_FRAME_CRC_BYTES)) != crc) {
+        return ESP_ERR_INVALID_CRC;
+    }
+
+    view->legacy = false;
+    view->seq = hdr->seq;
+    view->log_id = hdr->log_id;
+    view->fitness = hdr->fitness;
+    view->gene_count = hdr->gene_count;
+    memcpy(view->robot_id, hdr->robot_id, sizeof(hdr->robot_id));
+    view->robot_id[sizeof(hdr->robot_id)] = '\0';
+    return ESP_OK;
+}
+
+// Genes of "25.123|1.500|2.300|..." or, from a GA_QUANTISED_GENES robot,
+// "25.123|Q" and four hex digits per gene code over its own gene range,
+// which legacy messages do not carry: the local one is assumed.
+static int legacyGenes(const migration_frame_view_t *view, float *genes, int max_genes)
+{
+    char text[sizeof(((out_message_t *)0)->message)];
+    size_t start = offsetof(out_message_t, message);
+    size_t text_len = view->len - start < sizeof(text) ? view->len - start : sizeof(text);
+    memcpy(text, view->data + start, text_len);
+    text[sizeof(text) - 1] = '\0';
+
+    int count = 0;
+    char *token = strtok(text, "|");    // the fitness
+    token = strtok(NULL, "|");
+    if (token != NULL && token[0] == 'Q') {
+        const char *hex = token + 1;
+        for (; count < max_genes && strlen(hex) >= 4; count++, hex += 4) {
+            char code[5] = { hex[0], hex[1], hex[2], hex[3], '\0' };
+            genes[count] = ga_gene_dequantise((int16_t)strtoul(code, NULL, 16));
+        }
+        return count;
+    }
+    for (; token != NULL && count < max_genes; count++) {
+        genes[count] = strtof(token, NULL);
+        token = strtok(NULL, "|");
+    }
+    return count;
+}
+
+int migration_frame_genes(const migration_frame_view_t *view, float *genes, int max_genes)
+{
+    memset(genes, 0, max_genes * sizeof(float));
+    if (view->legacy) {
+        return legacyGenes(view, genes, max_genes);
+    }
+
+    const migration_frame_header_t *hdr = (const migration_frame_header_t *)view->data;
+    const uint8_t *p = view->data + sizeof(*hdr);
+    int count = view->gene_count < max_genes ? view->gene_count : max_genes;
+    if (hdr->flags & MIGRATION_FRAME_QUANTISED) {
+        float gene_min, gene_max;
+        memcpy(&gene_min, p, sizeof(float));
+        memcpy(&gene_max, p + sizeof(float), sizeof(float));
+        p += 2 * sizeof(float);
+        float mid = geneMid(gene_min, gene_max);
+        float step = geneStep(gene_min, gene_max);
+        for (int i = 0; i < count; i++) {
+            int16_t code;
+            memcpy(&code, p + i * sizeof(code), sizeof(code));
+            genes[i] = mid + (float)code * step;
+        }
+    } else {
+        memcpy(genes, p, count * sizeof(float));
+    }
+    return count;
+}
@@ -0,0 +1,55 @@
+#ifndef MIGRATION_FRAME_H
+#define MIGRATION_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "data_structures.h"
+
+// Encoder and decoder of the migration_frame_header_t frames
+// (data_structures.h) robots push their best solution in.
+//
+// A frame is decoded in place: migration_frame_view() checks it in the
+// receive buffer and only the header fields are read out, the genes are
+// converted by migration_frame_genes() once the migrant is wanted. Frames
+// from older firmware, an out_message_t with the genes as text, are
+// recognised and viewed the same way with legacy set.
+
+typedef struct {
+    const uint8_t *data;    // the received bytes, which must outlive the view
+    size_t len;
+    bool legacy;            // out_message_t text rather than a binary frame
+    char robot_id[5];
+    uint16_t seq;           // 0 for legacy messages
+    uint32_t log_id;
+    float fitness;
+    int gene_count;         // genes in a binary frame, -1 for legacy messages
+} migration_frame_view_t;
+
+// Writes the frame for hdr's seq, robot_id, log_id, created_datetime,
+// fitness and flags, and gene_count genes, into buf. Quantised frames
+// round the genes to codes over [gene_min, gene_max] as
+// ga_gene_quantise() does. Returns the frame length,
+// MIGRATION_FRAME_SIZE(), or 0 if it does not fit cap or an ESP-NOW frame.
+size_t migration_frame_encode(uint8_t *buf, size_t cap, const migration_frame_header_t *hdr,
+                              const float *genes, int gene_count, float gene_min, float gene_max);
+
+// ESP_OK for an intact binary frame or a legacy message.
+// ESP_ERR_INVALID_VERSION for a frame of a newer firmware,
+// ESP_ERR_INVALID_SIZE or ESP_ERR_INVALID_CRC for a damaged one.
+esp_err_t migration_frame_view(const uint8_t *data, size_t len, migration_frame_view_t *view);
+
+// Decodes up to max_genes genes of the viewed frame, 0 past its end.
+// Returns how many it carried.
+int migration_frame_genes(const migration_frame_view_t *view, float *genes, int max_genes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MIGRATION_FRAME_H
@@ -1,23 +1,46 @@
 #include "ga.h"
+#include "ga_fitness.h"
+#include "ga_rng.h"
+#include "ga_parallel.h"
+#include "ga_checkpoint.h"
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
 #include "https.h"
 #include "cJSON.h"
 #include "esp_log.h"
 #include "Arduino.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "esp_random.h"
 #include "globals.h"
 #include "data_logging.h"
 #include "espnow_main.h"
+#if GA_PROFILE
+#include "esp_cpu.h"
+#endif
 
 static const char *TAG = "GA";
 
-volatile bool ga_ended = false;
 TaskHandle_t ga_task_handle = NULL;
 
+#define GA_CMD_QUEUE_LEN 8
+
+typedef struct {
+    ga_cmd_id_t id;
+    int64_t enqueued_us;        // esp_timer time the command was queued
+    float genes[MAX_GENES];     // GA_CMD_INTEGRATE payload
+} ga_cmd_t;
+
+static QueueHandle_t s_ga_cmd_queue = NULL;
+static volatile bool s_stop_requested = false;
+static ga_worker_stats_t s_worker_stats;
+
 //TODO: handle error seed
 //Used to initialize the random seed
 uint16_t seed = 0; //0 error code
@@ -26,31 +49,55 @@ uint16_t seed = 0; //0 error code
 unsigned long dt;
 //track hyper-mutation
 bool ga_has_run_before = false;
-int s_hyper_mutation_generations = DEFAULT_HYPERMUTATION_GENERATIONS;
+int s_hyper_mutation_generations = DEFAULT_HYPERMUTATION_GENERATIONS; // length of every burst
 bool s_hyper_mutation_active = false;
 static float s_base_mutation_prob;
+static int s_hyper_level = 0;           // graded hyper-mutation, see GA_HYPER_MAX_LEVEL
+static int s_hyper_remaining = 0;       // generations left of the burst, or until the boost has faded
+static float s_hyper_last_best = -1.0f; // best fitness at the previous request
+static float s_sigma_boost = 1.0f;      // hyper-mutation multiplier of every island's sigma
+static uint32_t s_sigma_updates = 0;
 uint32_t s_last_ga_time = 0;
 
+// All per-individual state lives in one arena sized by init_ga() for
+// g_pop_size, see allocArena(). MAX_GENES stays a compile-time constant:
+// it is the width of a genome on the wire and in the fitness kernels.
+int g_pop_size = POP_SIZE;  // Population size the next init_ga() will use.
+static int s_pop_size = 0;  // Population size of the current arena.
+
 // This 2D array is all our candidate GA solutions.
 // 1st element: number of candidate solutions (pop_size)
 // 2nd element: number of dimensions of problem (problem parameters)
-float population[ POP_SIZE ][ MAX_GENES ];
-
-float fitness[ POP_SIZE ];  // To store fitness per solution.
+// It points at one of two ping-pong buffers: evolve() breeds children
+// into the other buffer, carries the elites across and swaps.
+// Genes are ga_gene_t, float or GA_QUANTISED_GENES codes.
+ga_gene_t (*population)[ MAX_GENES ] = NULL;
+static ga_gene_t (*s_pop_buf[2])[ MAX_GENES ];
+static int s_pop_front = 0;
+
+float *fitness = NULL;      // To store fitness per solution.
                             // Index correlates to population[][] index so
                             // avoid re-ordering either array or they will
                             // become mismatched/misaligned.
 
-int rank[ POP_SIZE ];       // Used to optimise a sorting routine on fitness.
-                            // Once createRanking() is called, then:
+int *rank = NULL;           // Used to optimise a sorting routine on fitness.
+                            // Once createRanking()/updateRanking() is called, then:
                             // rank[0] provides index to population[][] for the
                             // current worst population member, and rank[1] the
                             // second worst population member, etc.
-                            // So rank[POP_SIZE -1] is the best current solution.
-                            // rank[POP_SIZE-1] stores the INDEX of this solution
+                            // So rank[pop_size -1] is the best current solution.
+                            // rank[pop_size-1] stores the INDEX of this solution
                             // in the population[][] array.
 
-float true_f[ POP_SIZE ];   // Our roulette selection works as to optimise to maximum.
+static int *s_rank_scratch;         // Merge sort buffers.
+static int *s_rank_merged;
+
+static bool *s_fitness_dirty;          // Rows whose genes changed since their last evaluation.
+static ga_fitness_stats_t s_fitness_stats;
+static int s_children_evaluated = 0;   // Rows evolve() stored already evaluated, see storeFitness().
+static float *s_child_f;               // Fitness of the children bred this generation.
+
+float *true_f = NULL;       // Our roulette selection works as to optimise to maximum.
                             // However, rastrigin is a minimisation problem.  Therefore,
                             // we take the reciprocal of the rastrigin (1 + (1/rastrigin)) to 
                             // "convert" it into a maximisation problem.  This is a little
@@ -58,56 +105,602 @@ float true_f[ POP_SIZE ];   // Our roulette selection works as to optimise to ma
                             // original rastrigin value into this array just for 
                             // reviewing/debugging later.  
 
+static void *s_arena = NULL;           // Backing store of everything above, internal RAM.
+
+// Best fitness per generation, oldest overwritten first. Only read for
+// reports, so it goes to PSRAM and leaves internal RAM to the hot arrays.
+static float *s_best_history = NULL;
+static uint32_t s_history_count = 0;
+
 float g_mutate_prob = 0.6f; // Base mutation probability, can be changed at runtime.
 
+// Problem being optimised, see ga_fitness.h. g_fitness_function is read
+// by init_ga(), which sets up the rest from its registry entry.
+int g_fitness_function = GA_FITNESS_RASTRIGIN;
+const char *fitness_function = "RASTRIGIN";
+float gene_min_value = -5.12f;
+float gene_max_value = 5.12f;
+static ga_fitness_kernel_t s_fitness_kernel = ga_rastrigin;
+static float s_gene_mid = 0.0f;         // GA_QUANTISED_GENES code 0
+static float s_gene_step = 5.12f / GA_GENE_QMAX; // and the value of one code
+static float s_gene_inv_step = GA_GENE_QMAX / 5.12f;
+static float s_mutate_sd = MUTATE_WIDTH; // MUTATE_WIDTH scaled to the gene range
+bool g_adaptive_mutation = GA_ADAPTIVE_MUTATION; // Read every generation.
+int g_ga_engine = GA_DEFAULT_ENGINE;    // Optimiser the next init_ga() sets up.
+const char *ga_engine = "GA";
+static int s_engine_id = GA_ENGINE_GA;  // Optimiser of the current population.
+ga_local_search_mode_t g_local_search = GA_LOCAL_SEARCH; // Memetic refinement, read every generation.
+int g_local_search_budget = GA_LOCAL_SEARCH_EVALS;
+static ga_local_search_stats_t s_ls_stats;
+static ga_stagnation_t s_ls_stall;      // GA_LOCAL_SEARCH_ON_STALL trigger
+ga_selection_mode_t g_selection_mode = GA_SELECTION_ROULETTE; // Parent selection, can be changed at runtime.
+
+static float *s_cum_fitness;          // Prefix sums of fitness[], rebuilt once per generation.
+static float *s_alias_prob;           // Vose alias table, see prepareSelection().
+static int *s_alias_idx;
+static int *s_alias_work;
+static int *s_sus_parents;             // First parents for GA_SELECTION_SUS.
+
+// An island is the sub-population in rows [base, base + size). Its
+// ranking lives in rank[base .. base + size) and it owns the same slice
+// of every per-individual array (selection tables, merge buffers, child
+// fitness), so islands never write each other's entries and can breed on
+// different cores. With one island it is the whole population.
+typedef struct {
+    int base;
+    int size;
+    int unranked;                       // Leading slots of its rank[] slice replaced since
+                                        // the last ranking, see updateIslandRanking().
+    bool selection_ready;               // Cleared whenever its fitness[] changes.
+    ga_selection_mode_t prepared_mode;  // Mode the tables were built for.
+    ga_rng_t rng;                       // Island 0's is the GA's main generator.
+    float sigma;                        // Mutation standard dev, see GA_ADAPTIVE_MUTATION.
+    int successes;                      // Children that beat their first parent, this generation.
+    float success_rate;                 // Of the last generation.
+} ga_island_t;
+
+static ga_island_t s_islands[GA_MAX_ISLANDS];
+
+// sep-CMA-ES search distribution of one island, see GA_CMA_SIGMA0.
+typedef struct {
+    float mean[MAX_GENES];
+    float diag_c[MAX_GENES];            // Diagonal of the covariance matrix.
+    float pc[MAX_GENES];                // Evolution path of the covariance.
+    float ps[MAX_GENES];                // Evolution path of the step size.
+    float sigma;                        // Step size.
+    uint32_t updates;
+} ga_cma_t;
+
+static ga_cma_t s_cma[GA_MAX_ISLANDS];
+static int s_num_islands = 1;
+static uint32_t s_remote_migrants = 0; // Radio migrants integrated, picks their island.
+static uint32_t s_ring_migrations = 0;
+int g_num_islands = DEFAULT_NUM_ISLANDS;    // Island count the next init_ga() will use.
+int g_island_migration_interval = DEFAULT_ISLAND_MIGRATION_INTERVAL; // Generations between ring migrations.
+
+// Per-gene mean and sum of squared deviations of the population, kept up
+// to date by replaceRow() as rows are overwritten, see GA_DIVERSITY_REFRESH.
+static float s_gene_mean[MAX_GENES];
+static float s_gene_m2[MAX_GENES];
+float g_diversity_collapse = DEFAULT_DIVERSITY_COLLAPSE;
+
+static ga_rng_t s_helper_rng;          // Stream for parallel worker 1, island 0's jumped 2^64 ahead.
+
+bool g_parallel_evolve = false;        // Breed children on both cores, can be changed at runtime.
+
+bool g_ga_checkpoint = GA_CHECKPOINT;
+uint32_t g_checkpoint_interval_ms = GA_CHECKPOINT_INTERVAL_MS;
+bool g_ga_resume = DEFAULT_GA_RESUME;
+uint32_t ga_resumed_generation = 0;
+static ga_checkpoint_stats_t s_ckpt_stats;
+static void *s_ckpt_buf = NULL;         // Encoding buffer of ga_checkpoint_save(), PSRAM.
+static size_t s_ckpt_buf_len = 0;
+
+// Best individual as last published by the GA, read by other tasks
+// through ga_get_best_snapshot(). Seqlock: s_best_seq is odd while
+// publishBest() is writing, readers retry if it was odd or changed.
+static ga_best_snapshot_t s_best;
+static atomic_uint s_best_seq;
+static uint32_t s_generation = 0;
+#define GA_SNAPSHOT_SPINS 16   // failed reads before a reader sleeps a tick
+
+#if GA_PROFILE
+// Phase cycles of one generation (or call), see GA_PROFILE.
+typedef struct {
+    uint32_t start;
+    uint32_t cycles[GA_PHASE_COUNT];
+} ga_phase_clock_t;
+
+static ga_phase_stats_t s_phase_stats[GA_PHASE_COUNT];  // since init_ga()
+static ga_phase_stats_t s_phase_window[GA_PHASE_COUNT]; // since the last log record
+
+// Fitness and selection cycles of whichever task is breeding, so the GA
+// task can take its own share out of its breeding time.
+static _Thread_local ga_phase_clock_t s_worker_clock;
+
+static const char *const s_phase_names[GA_PHASE_COUNT] = {
+    "fit", "rank", "sel", "breed", "copy", "log", "push",
+};
+
+static void addPhaseSample(ga_phase_stats_t *st, uint32_t cycles) {
+    if (st->count == 0 || cycles < st->min_cycles) st->min_cycles = cycles;
+    if (cycles > st->max_cycles) st->max_cycles = cycles;
+    st->total_cycles += cycles;
+    st->count++;
+}
+
+static void recordPhase(int phase, uint32_t cycles) {
+    addPhaseSample(&s_phase_stats[phase], cycles);
+    addPhaseSample(&s_phase_window[phase], cycles);
+}
+
+#define GA_CLOCK_DECLARE(c)     ga_phase_clock_t c = { 0 }
+#define GA_CLOCK_START(c)       ((c).start = (uint32_t)esp_cpu_get_cycle_count())
+#define GA_CLOCK_STOP(c, phase) ((c).cycles[phase] += (uint32_t)esp_cpu_get_cycle_count() - (c).start)
+#define GA_CLOCK_RESET(c)       memset(&(c), 0, sizeof(c))
+#define GA_CLOCK_RECORD(c, phase) recordPhase((phase), (c).cycles[phase])
+#define GA_PROFILE_CALL(phase, call) do { \
+        uint32_t start_ = (uint32_t)esp_cpu_get_cycle_count(); \
+        call; \
+        recordPhase((phase), (uint32_t)esp_cpu_get_cycle_count() - start_); \
+    } while (0)
+#else
+#define GA_CLOCK_DECLARE(c)
+#define GA_CLOCK_START(c)       ((void)0)
+#define GA_CLOCK_STOP(c, phase) ((void)0)
+#define GA_CLOCK_RESET(c)       ((void)0)
+#define GA_CLOCK_RECORD(c, phase) ((void)0)
+#define GA_PROFILE_CALL(phase, call) call
+#endif
+
+int16_t ga_gene_quantise(float gene) {
+    float q = (gene - s_gene_mid) * s_gene_inv_step;
+    if (q > GA_GENE_QMAX) q = GA_GENE_QMAX;
+    if (q < -GA_GENE_QMAX) q = -GA_GENE_QMAX;
+    return (int16_t)lrintf(q);
+}
+
+float ga_gene_dequantise(int16_t code) {
+    return s_gene_mid + (float)code * s_gene_step;
+}
+
+static inline float geneValue(ga_gene_t gene) {
+#if GA_QUANTISED_GENES
+    return ga_gene_dequantise(gene);
+#else
+    return gene;
+#endif
+}
+
+static inline void decodeRow(float *genes, const ga_gene_t *row) {
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        genes[gene] = geneValue(row[gene]);
+    }
+}
+
+// Store genes[] into row[] and round genes[] to what was stored.
+static inline void encodeRow(ga_gene_t *row, float *genes) {
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+#if GA_QUANTISED_GENES
+        row[gene] = ga_gene_quantise(genes[gene]);
+        genes[gene] = ga_gene_dequantise(row[gene]);
+#else
+        row[gene] = genes[gene];
+#endif
+    }
+}
+
+// Carve the arena into the per-individual arrays for n individuals.
+// With base == 0 it only measures; returns the bytes needed.
+static size_t layoutArena(uintptr_t base, int n) {
+    uintptr_t at = base;
+#define GA_CARVE(ptr, count) do { \
+        at = (at + 7) & ~(uintptr_t)7; \
+        (ptr) = (void *)at; \
+        at += (size_t)(count) * sizeof(*(ptr)); \
+    } while (0)
+
+    GA_CARVE(s_pop_buf[0], n);
+    GA_CARVE(s_pop_buf[1], n);
+    GA_CARVE(fitness, n);
+    GA_CARVE(true_f, n);
+    GA_CARVE(rank, n);
+    GA_CARVE(s_rank_scratch, n);
+    GA_CARVE(s_rank_merged, n);
+    GA_CARVE(s_cum_fitness, n);
+    GA_CARVE(s_alias_prob, n);
+    GA_CARVE(s_alias_idx, n);
+    GA_CARVE(s_alias_work, n);
+    GA_CARVE(s_sus_parents, n);
+    GA_CARVE(s_child_f, n);
+    GA_CARVE(s_fitness_dirty, n);
+#undef GA_CARVE
+
+    return (size_t)(at - base) + 8;
+}
+
+// (Re)build the arena for n individuals. The hot arrays are read every
+// generation by the GA task and the core 0 helper, so they are asked for
+// in internal RAM; only if that fails do they fall back to PSRAM.
+static esp_err_t allocArena(int n) {
+    if (n == s_pop_size && s_arena != NULL) {
+        return ESP_OK;
+    }
+    if (n < 2) {
+        ESP_LOGE(TAG, "Population size %d too small", n);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t bytes = layoutArena(0, n);
+    void *arena = heap_caps_calloc(1, bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (arena == NULL) {
+        ESP_LOGW(TAG, "No internal RAM for a %u byte GA arena, using PSRAM", (unsigned)bytes);
+        arena = heap_caps_calloc(1, bytes, MALLOC_CAP_DEFAULT);
+    }
+    if (arena == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate GA arena for %d individuals", n);
+        return ESP_ERR_NO_MEM;
+    }
+
+    heap_caps_free(s_arena);
+    s_arena = arena;
+    layoutArena(((uintptr_t)arena + 7) & ~(uintptr_t)7, n);
+    s_pop_size = n;
+    s_pop_front = 0;
+    population = s_pop_buf[0];
+
+    if (s_best_history == NULL) {
+        s_best_history = heap_caps_malloc(GA_HISTORY_LEN * sizeof(float), MALLOC_CAP_SPIRAM);
+        if (s_best_history == NULL) {
+            s_best_history = heap_caps_malloc(GA_HISTORY_LEN * sizeof(float), MALLOC_CAP_DEFAULT);
+        }
+    }
+    s_history_count = 0;
+
+    ESP_LOGI(TAG, "GA arena: %d individuals, %u bytes", n, (unsigned)bytes);
+    return ESP_OK;
+}
+
+// Centre of the gene range, unit covariance, no history.
+static void resetCma(ga_cma_t *cma) {
+    float range = gene_max_value - gene_min_value;
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        cma->mean[gene] = gene_min_value + 0.5f * range;
+        cma->diag_c[gene] = 1.0f;
+        cma->pc[gene] = 0.0f;
+        cma->ps[gene] = 0.0f;
+    }
+    cma->sigma = GA_CMA_SIGMA0 * range;
+    cma->updates = 0;
+}
+
+// Split the n rows of the arena into count islands of near equal size,
+// the first n % count islands taking one extra row.
+static esp_err_t layoutIslands(int n, int count) {
+    if (count < 1 || count > GA_MAX_ISLANDS || n / count < GA_MIN_ISLAND_SIZE) {
+        ESP_LOGE(TAG, "Cannot split %d individuals into %d islands", n, count);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int base = 0;
+    for (int k = 0; k < count; k++) {
+        ga_island_t *isl = &s_islands[k];
+        isl->base = base;
+        isl->size = n / count + (k < n % count ? 1 : 0);
+        isl->unranked = 0;
+        isl->selection_ready = false;
+        isl->sigma = s_mutate_sd;
+        isl->successes = 0;
+        isl->success_rate = 0.0f;
+        resetCma(&s_cma[k]);
+        base += isl->size;
+    }
+    s_num_islands = count;
+
+    // A new population starts without any hyper-mutation history
+    s_hyper_mutation_active = false;
+    s_hyper_level = 0;
+    s_hyper_remaining = 0;
+    s_hyper_last_best = -1.0f;
+    s_sigma_boost = 1.0f;
+    s_sigma_updates = 0;
+
+    // Nor any local search
+    memset(&s_ls_stats, 0, sizeof(s_ls_stats));
+    s_ls_stats.step = s_mutate_sd;
+    ga_stagnation_reset(&s_ls_stall, GA_LOCAL_SEARCH_STALL);
+    return ESP_OK;
+}
+
+// Record that the rows at the first count slots of the island's rank[]
+// slice have been overwritten: they need a new fitness and a new place
+// in the ranking.
+static void markReplaced(ga_island_t *isl, int count) {
+    if (count > isl->size) {
+        count = isl->size;
+    }
+    for (int i = 0; i < count; i++) {
+        s_fitness_dirty[rank[isl->base + i]] = true;
+    }
+    if (count > isl->unranked) {
+        isl->unranked = count;
+    }
+}
+
+// rank[] slot of the best individual of an island.
+static inline int islandTop(const ga_island_t *isl) {
+    return isl->base + isl->size - 1;
+}
+
+// Island holding the overall best individual, rank[] must be sorted.
+static ga_island_t *bestIsland(void) {
+    ga_island_t *best = &s_islands[0];
+    for (int k = 1; k < s_num_islands; k++) {
+        if (fitness[rank[islandTop(&s_islands[k])]] > fitness[rank[islandTop(best)]]) {
+            best = &s_islands[k];
+        }
+    }
+    return best;
+}
+
+// Row of the overall best individual, rank[] must be sorted.
+static int bestRow(void) {
+    return rank[islandTop(bestIsland())];
+}
+
+// Account for a population row changing from old_genes[] to new_genes[]:
+// Welford's update for replacing one sample, stable in single precision.
+// Call before the row is overwritten.
+static void replaceRow(const ga_gene_t *old_genes, const ga_gene_t *new_genes) {
+    float n = (float)s_pop_size;
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float old_value = geneValue(old_genes[gene]);
+        float new_value = geneValue(new_genes[gene]);
+        float d = new_value - old_value;
+        float mean = s_gene_mean[gene] + d / n;
+        s_gene_m2[gene] += d * (new_value - mean + old_value - s_gene_mean[gene]);
+        s_gene_mean[gene] = mean;
+    }
+}
+
+// Two pass mean and squared deviations of the current population.
+static void measureGeneSpread(float *mean, float *m2) {
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        mean[gene] = 0.0f;
+        m2[gene] = 0.0f;
+    }
+    for (int row = 0; row < s_pop_size; row++) {
+        for (int gene = 0; gene < MAX_GENES; gene++) {
+            mean[gene] += geneValue(population[row][gene]);
+        }
+    }
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        mean[gene] /= (float)s_pop_size;
+    }
+    for (int row = 0; row < s_pop_size; row++) {
+        for (int gene = 0; gene < MAX_GENES; gene++) {
+            float d = geneValue(population[row][gene]) - mean[gene];
+            m2[gene] += d * d;
+        }
+    }
+}
+
+static float diversityOf(const float *m2) {
+    float sum = 0.0f;
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        sum += (m2[gene] > 0.0f) ? m2[gene] : 0.0f;
+    }
+    return sqrtf(sum / ((float)s_pop_size * MAX_GENES)) / (gene_max_value - gene_min_value);
+}
+
+float ga_measure_diversity(void) {
+    float mean[MAX_GENES], m2[MAX_GENES];
+    measureGeneSpread(mean, m2);
+    return diversityOf(m2);
+}
+
+// Copy the current best (the best of the island tops) into the snapshot.
+// Called by the GA task only, with rank[] freshly sorted.
+static void publishBest(void) {
+    int best = bestRow();
+    unsigned seq = atomic_load_explicit(&s_best_seq, memory_order_relaxed);
+
+    atomic_store_explicit(&s_best_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    s_best.fitness = true_f[best];
+    decodeRow(s_best.genes, population[best]);
+    s_best.generation = s_generation;
+    s_best.timestamp_us = esp_timer_get_time();
+    s_best.diversity = diversityOf(s_gene_m2);
+
+    atomic_store_explicit(&s_best_seq, seq + 2, memory_order_release);
+}
 
 // Utility function to generate a random floating-point number within a range
 float randFloat(float min, float max) {
-    return min + ((float)rand() / (float)RAND_MAX) * (max - min);
+    return ga_rng_range(&s_islands[0].rng, min, max);
+}
+
+// Hyper-mutation boost for this generation, fading linearly from its
+// level down to nothing over s_hyper_mutation_generations.
+static void applyHyperMutation(void) {
+    if (s_hyper_remaining <= 0) {
+        if (s_hyper_mutation_active) {
+            s_hyper_mutation_active = false;
+            s_sigma_boost = 1.0f;
+            g_mutate_prob = s_base_mutation_prob;
+        }
+        return;
+    }
+
+    float fade = (float)s_hyper_remaining / (float)s_hyper_mutation_generations;
+    float level = (float)s_hyper_level / GA_HYPER_MAX_LEVEL;
+    s_sigma_boost = 1.0f + (powf(GA_HYPER_SIGMA_BOOST, (float)s_hyper_level) - 1.0f) * fade;
+    g_mutate_prob = s_base_mutation_prob + (1.0f - s_base_mutation_prob) * level * fade;
+    s_hyper_remaining--;
 }
 
 void activate_hyper_mutation(void) {
     
     s_hyper_mutation_active = true;
-    //s_hyper_mutation_generations = 10;
-    g_mutate_prob = 1.0f; //100% mutation rate
+    if (g_adaptive_mutation) {
+        // Escalate while repeated requests find no progress
+        float best = true_f[bestRow()];
+        if (s_hyper_level == 0 || best < s_hyper_last_best - GA_STAGNATION_THRESHOLD) {
+            s_hyper_level = 1;
+        } else if (s_hyper_level < GA_HYPER_MAX_LEVEL) {
+            s_hyper_level++;
+        }
+        s_hyper_last_best = best;
+        s_hyper_remaining = s_hyper_mutation_generations;
+    } else {
+        s_hyper_remaining = s_hyper_mutation_generations;
+        g_mutate_prob = 1.0f; //100% mutation rate
+    }
     //ESP_LOGI(TAG, "Hyper-mutation activated");
 
-    //mass extinction: reinitialize half of the worst-performing population
-    //int half_pop = POP_SIZE / 2;
-    float range = MAX_GENE_VALUE - MIN_GENE_VALUE;
-    for (int i = 0; i < DEFAULT_MASS_EXTINCTION; i++) {
-        int worst_index = rank[i];
-        for (int gene = 0; gene < MAX_GENES; gene++) {
-            float randomVal = (float)esp_random() / (float)UINT32_MAX; 
-            float scaledVal = MIN_GENE_VALUE + randomVal * range;
-            population[worst_index][gene] = scaledVal;
+    // sep-CMA-ES restarts its step size rather than its rows: a mass
+    // extinction would only drag the next mean towards random points.
+    if (s_engine_id == GA_ENGINE_SEP_CMA) {
+        float range = gene_max_value - gene_min_value;
+        float boost = powf(GA_HYPER_SIGMA_BOOST, (float)(s_hyper_level > 0 ? s_hyper_level : 1));
+        for (int k = 0; k < s_num_islands; k++) {
+            ga_cma_t *cma = &s_cma[k];
+            cma->sigma *= boost;
+            if (cma->sigma > GA_CMA_SIGMA_MAX * range) cma->sigma = GA_CMA_SIGMA_MAX * range;
+            memset(cma->pc, 0, sizeof(cma->pc));
+            memset(cma->ps, 0, sizeof(cma->ps));
+        }
+        return;
+    }
+
+    //mass extinction: reinitialize the worst MASS_EXTINCTION_PERCENT (half)
+    //of the population, island by island so every island keeps its own elites
+    float range = gene_max_value - gene_min_value;
+    for (int k = 0; k < s_num_islands; k++) {
+        ga_island_t *isl = &s_islands[k];
+        int half_pop = isl->size * MASS_EXTINCTION_PERCENT / 100; // the island's share
+        if (half_pop > isl->size - 1) {
+            half_pop = isl->size - 1; // keep the island's best
+        }
+        for (int i = 0; i < half_pop; i++) {
+            int worst_index = rank[isl->base + i];
+            float fresh[MAX_GENES];
+            ga_gene_t row[MAX_GENES];
+            for (int gene = 0; gene < MAX_GENES; gene++) {
+                float randomVal = ga_rng_uniform(&isl->rng);
+                fresh[gene] = gene_min_value + randomVal * range;
+            }
+            encodeRow(row, fresh);
+            replaceRow(population[worst_index], row);
+            memcpy(population[worst_index], row, sizeof(row));
         }
+        markReplaced(isl, half_pop);
     }
 }
 
-/*
- *  From: http://www.taygeta.com/random/gaussian.html
- *  
- *  This routine is a little troubling because it is 
- *  non-deterministic (we don't know when it will solve)
- *  and computationally expensive.
- *  However, using gaussian distribution is useful for 
- *  GAs to create an often-small mutation with occassional
- *  big mutation.  Uniform random numbers don't do this.
- */
+// Using gaussian distribution is useful for GAs to create an
+// often-small mutation with occassional big mutation. Uniform random
+// numbers don't do this. Sampled with the ziggurat in ga_rng.c, which
+// needs no log/sqrt and no rejection loop on the common path.
 float randGaussian(float mean, float sd) {
-    float x1, x2, w, y;
+    return mean + sd * ga_rng_gaussian(&s_islands[0].rng);
+}
+
+// Build the selection tables of one island for the current fitness[].
+// Fitness only changes in determineFitness(), so this runs once per
+// generation rather than once per draw. The prefix sums are always built,
+// the alias table only in GA_SELECTION_ALIAS mode. Tables are indexed by
+// population row and cover only the island's rows.
+static void prepareIslandSelection(ga_island_t *isl) {
+    int lo = isl->base;
+    int n = isl->size;
+    float cumulative_sum = 0.0f;
+    for (int i = lo; i < lo + n; i++) {
+        cumulative_sum += fitness[i];
+        s_cum_fitness[i] = cumulative_sum;
+    }
+
+    if (g_selection_mode == GA_SELECTION_ALIAS) {
+        // Vose's alias method. Scale each fitness so the mean is 1, then
+        // pair every "small" (< 1) column with a "large" one that donates
+        // the remainder. work[] holds the small stack growing up from 0
+        // and the large stack growing down from n - 1.
+        int *work = s_alias_work + lo;
+        float scale = (float)n / cumulative_sum;
+        int n_small = 0;
+        int n_large = 0;
+        for (int i = lo; i < lo + n; i++) {
+            s_alias_prob[i] = fitness[i] * scale;
+            if (s_alias_prob[i] < 1.0f) {
+                work[n_small++] = i;
+            } else {
+                work[n - 1 - n_large++] = i;
+            }
+        }
+        while (n_small > 0 && n_large > 0) {
+            int small = work[--n_small];
+            int large = work[n - n_large];
+            s_alias_idx[small] = large;
+            s_alias_prob[large] = (s_alias_prob[large] + s_alias_prob[small]) - 1.0f;
+            if (s_alias_prob[large] < 1.0f) {
+                n_large--;
+                work[n_small++] = large;
+            }
+        }
+        // Whatever is left is 1 up to rounding error
+        while (n_large > 0) {
+            s_alias_prob[work[n - n_large--]] = 1.0f;
+        }
+        while (n_small > 0) {
+            s_alias_prob[work[--n_small]] = 1.0f;
+        }
+    }
 
-    do {
-        x1 = 2.0 * randFloat(0.0,1.0) - 1.0; // Generate uniform random value between -1 and 1
-        x2 = 2.0 * randFloat(0.0,1.0) - 1.0; // Generate uniform random value between -1 and 1
-        w = (x1 * x1) + (x2 * x2);
-    } while (w >= 1.0); // Ensure that the point is inside the unit circle
+    isl->prepared_mode = g_selection_mode;
+    isl->selection_ready = true;
+}
+
+void prepareSelection(void) {
+    for (int k = 0; k < s_num_islands; k++) {
+        prepareIslandSelection(&s_islands[k]);
+    }
+}
+
+static void ensureSelection(ga_island_t *isl) {
+    if (!isl->selection_ready || isl->prepared_mode != g_selection_mode) {
+        prepareIslandSelection(isl);
+    }
+}
+
+// Row of the first prefix sum >= stop, i.e. the same individual the
+// linear cumulative walk would stop on.
+static int searchCumulative(const ga_island_t *isl, float stop) {
+    int lo = isl->base;
+    int hi = islandTop(isl);
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (s_cum_fitness[mid] >= stop) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
 
-    w = sqrt((-2.0 * log(w)) / w); // Compute scaling factor
-    y = x1 * w; // y is normally distributed
-    return mean + y * sd; // Scale by standard deviation and adjust by mean
+// One fitness proportionate draw from the island's prepared tables. Only
+// reads shared state, so parallel workers can call it with their own rng.
+static int selectParent(const ga_island_t *isl, ga_rng_t *rng) {
+    if (g_selection_mode == GA_SELECTION_ALIAS) {
+        int column = isl->base + (int)ga_rng_below(rng, isl->size);
+        return (ga_rng_range(rng, 0.0, 1.0) < s_alias_prob[column]) ? column : s_alias_idx[column];
+    }
+
+    // Generate a random stopping point along the cumulative sum of fitnesses
+    float stop = ga_rng_range(rng, 0.0, s_cum_fitness[islandTop(isl)]);
+    return searchCumulative(isl, stop);
 }
 
 // This is a standard selection mechanism, plenty of 
@@ -115,35 +708,76 @@ float randGaussian(float mean, float sd) {
 // https://en.wikipedia.org/wiki/Fitness_proportionate_selection
 // Note, we have preconditioned our fitness (rastrigin) to
 // convert it to a maximisation problem so this routine works.
+// A draw is a binary search of the island's cumulative fitness
+// prefix sums, or O(1) from the alias table in GA_SELECTION_ALIAS.
+// Draws from island 0, which is the whole population unless the GA was
+// split into islands.
 int rouletteSelection(void) {
-    float sum_fitness = 0.0;
-    int i;
+    ga_island_t *isl = &s_islands[0];
+    ensureSelection(isl);
+    return selectParent(isl, &isl->rng);
+}
 
-    // Calculate the sum of all fitness values
-    for (i = 0; i < POP_SIZE; i++) {
-        sum_fitness += fitness[i];
-    }
-    
-    // Generate a random stopping point along the cumulative sum of fitnesses
-    float stop = randFloat(0.0, sum_fitness);
-    
-    // Move through each fitness and end when the value is
-    // greater or equal to the stop position
-    float cumulative_sum = 0.0;
-    for (i = 0; i < POP_SIZE; i++) {
-        cumulative_sum += fitness[i];
-        if (cumulative_sum >= stop) {
-            return i;
+// Stochastic universal sampling: one random offset and count equally
+// spaced pointers along the cumulative fitness pick every parent in a
+// single pass, with less spread than count independent roulette draws.
+static void susIslandSelection(ga_island_t *isl, ga_rng_t *rng, int *parents, int count) {
+    ensureSelection(isl);
+
+    int last = islandTop(isl);
+    float step = s_cum_fitness[last] / count;
+    float pointer = ga_rng_range(rng, 0.0, step);
+    int i = isl->base;
+    for (int p = 0; p < count; p++) {
+        while (i < last && s_cum_fitness[i] < pointer) {
+            i++;
         }
+        parents[p] = i;
+        pointer += step;
+    }
+
+    // Parents come out in population order, shuffle them so children
+    // are not paired with neighbouring parents for crossover.
+    for (int p = count - 1; p > 0; p--) {
+        int r = (int)ga_rng_below(rng, p + 1);
+        int hold = parents[p];
+        parents[p] = parents[r];
+        parents[r] = hold;
     }
+}
 
-    // In the unlikely event that floating-point precision leads to not selecting
-    // simply return the last index (should technically never happen)
-    return POP_SIZE - 1;
+void susSelection(int *parents, int count) {
+    susIslandSelection(&s_islands[0], &s_islands[0].rng, parents, count);
+}
+
+// Store row individual's fitness from its raw function value f.
+static void storeFitness(int individual, float f) {
+    // Store the original Rastrigin value
+    // Before we take the reciprocal to convert this to
+    // a maximisation problem, we store the original 
+    // rastrigin fitness.  This is what we really want to
+    // see when we review the results.
+    true_f[individual] = f;
+    
+    // Avoid division by zero
+    fitness[individual] = 1.0f / (f + 1.0f);
+    s_fitness_dirty[individual] = false;
+}
+
+// Fitness function value of a stored row.
+static inline float evaluateRow(const ga_gene_t *row) {
+#if GA_QUANTISED_GENES
+    float genes[MAX_GENES];
+    decodeRow(genes, row);
+    return s_fitness_kernel(genes);
+#else
+    return s_fitness_kernel(row);
+#endif
 }
 
 // The fitness function is key to any GA.
-// The rastrigin function is implemented here.
+// The rastrigin function is the default, the other
+// benchmark functions in ga_fitness.h work the same way.
 // Rastrigin is a minimisation problem, but our
 // roulette method selection works to maximise.
 // Therefore, we set the fitness (f) as the reciprocal of
@@ -151,80 +785,152 @@ int rouletteSelection(void) {
 // However, if rastrigin solves (e.g rastrigin_fitness = 0)
 // we would get an error of (1/0), so we add an offset
 // to the denominator, creating f = (1 / (rastrigin_fitness+1) ).
-void determineFitness() {
-    float f;
+// The per-gene maths lives in ga_fitness.h and is single precision,
+// one kernel call per genome through s_fitness_kernel.
+void determineFitness(void) {
+    int evaluated = 0;
+
+    for (int individual = 0; individual < s_pop_size; individual++) {
+        // Elites carried over from the last generation still hold
+        // the fitness they were given then.
+        if (!s_fitness_dirty[individual]) {
+            continue;
+        }
 
-    for (int individual = 0; individual < POP_SIZE; individual++) {
         // For each population member, determine the succes (fitness).
-        // Here, we just sum each value
-        f = 0;
-        float p0;
-        float p1;
-        float f_sum = 0.0;
+        storeFitness(individual, evaluateRow(population[individual]));
+        evaluated++;
+    }
 
-        for (int gene = 0; gene < MAX_GENES; gene++) {
-            float geneValue = population[individual][gene];
-            // Rastrigin Function:
-            p0 = pow(geneValue, 2);
-            p1 = A * cos(TWO_PI * geneValue);
-            f_sum += (p0 - p1);
+    // Children inserted by the last evolve() came with their fitness,
+    // they were evaluated there rather than skipped.
+    s_fitness_stats.evaluated += evaluated;
+    s_fitness_stats.skipped += s_pop_size - evaluated - s_children_evaluated;
+    s_children_evaluated = 0;
+    if (evaluated > 0) {
+        for (int k = 0; k < s_num_islands; k++) {
+            s_islands[k].selection_ready = false;
         }
+    }
+}
+
+void ga_invalidate_fitness(void) {
+    for (int individual = 0; individual < s_pop_size; individual++) {
+        s_fitness_dirty[individual] = true;
+    }
+}
 
-        f = A * MAX_GENES + f_sum;
+void ga_get_fitness_stats(ga_fitness_stats_t *out) {
+    *out = s_fitness_stats;
+}
 
-        // Store the original Rastrigin value
-        // Before we take the reciprocal to convert this to
-        // a maximisation problem, we store the original 
-        // rastrigin fitness.  This is what we really want to
-        // see when we review the results.
-        true_f[individual] = f;
-        
-        // Avoid division by zero
-        f = 1.0 / (f + 1.0);
+void ga_get_local_search_stats(ga_local_search_stats_t *out) {
+    *out = s_ls_stats;
+}
+
+#if GA_PROFILE
+void ga_get_phase_stats(ga_phase_stats_t *out) {
+    memcpy(out, s_phase_stats, sizeof(s_phase_stats));
+}
+
+const char *ga_phase_name(int phase) {
+    return (phase >= 0 && phase < GA_PHASE_COUNT) ? s_phase_names[phase] : NULL;
+}
+#endif
+
+void ga_get_mutation_stats(ga_mutation_stats_t *out) {
+    out->sigma = (s_engine_id == GA_ENGINE_SEP_CMA) ? s_cma[0].sigma : s_islands[0].sigma;
+    out->success_rate = s_islands[0].success_rate;
+    out->sigma_boost = s_sigma_boost;
+    out->hyper_level = s_hyper_level;
+    out->sigma_updates = s_sigma_updates;
+}
+
+// Merge two runs of population indices, each already in ascending
+// fitness order, into out[]. On equal fitness the entry from a[] goes
+// first, so the merge is stable.
+static void mergeRankRuns(const int *a, int na, const int *b, int nb, int *out) {
+    int i = 0, j = 0, k = 0;
+
+    while (i < na && j < nb) {
+        if (fitness[b[j]] < fitness[a[i]]) {
+            out[k++] = b[j++];
+        } else {
+            out[k++] = a[i++];
+        }
+    }
+    while (i < na) out[k++] = a[i++];
+    while (j < nb) out[k++] = b[j++];
+}
+
+// Bottom-up merge sort of idx[0..n) by fitness, scratch[] holds n more.
+// O(n log n) compares against the O(n^2) of the bubble sort this replaced.
+static void sortRankSlice(int *idx, int *scratch, int n) {
+    int *src = idx;
+    int *dst = scratch;
+
+    for (int width = 1; width < n; width *= 2) {
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            int mid = (lo + width < n) ? lo + width : n;
+            int hi = (lo + 2 * width < n) ? lo + 2 * width : n;
+            mergeRankRuns(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+        }
+        int *swap = src;
+        src = dst;
+        dst = swap;
+    }
 
-        // Assign calculated fitness
-        fitness[individual] = f;
+    if (src != idx) {
+        memcpy(idx, src, n * sizeof(int));
     }
 }
 
-// Using a simple bubble sort to determine the ranking of each
-// individual in the population. Note that it is computationally
+// Full ranking of one island. Note that it is computationally
 // expensive to reorder large arrays of numbers. Therefore, this
 // function re-orders the index values stored in the rank array.
 // That way we avoid copying around arrays.
-void createRanking(void) {
-    int i;
-
-    // We don't want to affect the actual assignment
-    // of fitness per individual, so here we create 
-    // a duplicate array.
-    float temp_f[POP_SIZE];
-
+static void createIslandRanking(ga_island_t *isl) {
     // Set initial ranking into unsorted index order
-    for (i = 0; i < POP_SIZE; i++) {
+    for (int i = isl->base; i < isl->base + isl->size; i++) {
         rank[i] = i;
-        temp_f[i] = fitness[i];
     }
-    
-    int sort;
-    int genotype;
-
-    // Perform bubble sort on the temporary fitness array
-    for (sort = 0; sort < POP_SIZE; sort++) {
-        for (genotype = 0; genotype < POP_SIZE - 1; genotype++) {
-            // Compare this genotype to the next
-            if (temp_f[genotype] > temp_f[genotype + 1]) {
-                // Swap rank indices
-                int rank_hold = rank[genotype + 1];
-                rank[genotype + 1] = rank[genotype];
-                rank[genotype] = rank_hold;
-
-                // Swap fitness values in the temporary array
-                float fitn_hold = temp_f[genotype + 1];
-                temp_f[genotype + 1] = temp_f[genotype];
-                temp_f[genotype] = fitn_hold;
-            }
-        }
+
+    sortRankSlice(rank + isl->base, s_rank_scratch + isl->base, isl->size);
+    isl->unranked = 0;
+}
+
+void createRanking(void) {
+    for (int k = 0; k < s_num_islands; k++) {
+        createIslandRanking(&s_islands[k]);
+    }
+}
+
+// Incremental ranking. Every writer of new genes (children, migrants,
+// mass extinction) overwrites the rows indexed by the front of the
+// island's rank[] slice, so after a generation only its first unranked
+// slots are out of order while the elites behind them are still sorted.
+// Sort just the replaced slots and merge them with the elites in a single
+// O(size) pass.
+static void updateIslandRanking(ga_island_t *isl) {
+    if (isl->unranked >= isl->size) {
+        createIslandRanking(isl);
+        return;
+    }
+    if (isl->unranked <= 0) {
+        return;
+    }
+
+    int *slice = rank + isl->base;
+    sortRankSlice(slice, s_rank_scratch + isl->base, isl->unranked);
+    mergeRankRuns(slice, isl->unranked, slice + isl->unranked, isl->size - isl->unranked,
+                  s_rank_merged + isl->base);
+    memcpy(slice, s_rank_merged + isl->base, isl->size * sizeof(int));
+    isl->unranked = 0;
+}
+
+void updateRanking(void) {
+    for (int k = 0; k < s_num_islands; k++) {
+        updateIslandRanking(&s_islands[k]);
     }
 }
 
@@ -275,27 +981,44 @@ static uint16_t init_random_seed(bool wifiAvailable) {
     return seed;
 }
 
+// Everything random in the GA draws from the island generators, all
+// derived from one seed, so the same seed replays the same run. Island 0
+// is seeded directly; the parallel helper and every further island each
+// get a stream jumped 2^64 ahead of the one before. The helper only
+// splits island 0's children, which only happens with a single island,
+// so it may share island 1's stream.
+static void seedIslands(uint16_t seed) {
+    ga_rng_seed(&s_islands[0].rng, seed);
+    s_helper_rng = s_islands[0].rng;
+    ga_rng_jump(&s_helper_rng);
+    for (int k = 1; k < s_num_islands; k++) {
+        s_islands[k].rng = s_islands[k - 1].rng;
+        ga_rng_jump(&s_islands[k].rng);
+    }
+}
+
 static void init_population(bool wifiAvailable) {
     // Utility to randomize initial population
     ESP_LOGI(TAG, "Randomizing initial population");
     uint16_t seed = init_random_seed(wifiAvailable);
+    seedIslands(seed);
     if (seed == 0) {
         ESP_LOGE(TAG, "Failed to fetch random seed");
         return;
     }
 
-    srand(seed);
-
     // Calculate range for gene values
-    float range = MAX_GENE_VALUE - MIN_GENE_VALUE;
+    float range = gene_max_value - gene_min_value;
 
     // Initialise with a random uniform distribution across all population members and genes
-    for (int individual = 0; individual < POP_SIZE; individual++) {
+    for (int individual = 0; individual < s_pop_size; individual++) {
+        float genes[MAX_GENES];
         for (int gene = 0; gene < MAX_GENES; gene++) {
-            // Generate random float within [MIN_GENE_VALUE, MAX_GENE_VALUE]
-            float randomValue = (float)rand() / (float)RAND_MAX; // Normalized to [0, 1]
-            population[individual][gene] = MIN_GENE_VALUE + randomValue * range;
+            // Generate random float within [gene_min_value, gene_max_value]
+            float randomValue = ga_rng_uniform(&s_islands[0].rng); // Normalized to [0, 1)
+            genes[gene] = gene_min_value + randomValue * range;
         }
+        encodeRow(population[individual], genes);
 
         // Set initial fitness to zero
         fitness[individual] = 0.0;
@@ -303,19 +1026,28 @@ static void init_population(bool wifiAvailable) {
     }
 
     // Optionally determine fitness after initialization
+    ga_invalidate_fitness();
+    memset(&s_fitness_stats, 0, sizeof(s_fitness_stats));
+    s_children_evaluated = 0;
+    s_remote_migrants = 0;
+    s_ring_migrations = 0;
     determineFitness();
+    createRanking();
+    measureGeneSpread(s_gene_mean, s_gene_m2);
+    s_generation = 0;
+    publishBest();
 }
 
 void print_population(void) {
     ESP_LOGI(TAG, " "); // space our reporting to make it easier to see
 
-    for (int individual = 0; individual < POP_SIZE; individual++) {
+    for (int individual = 0; individual < s_pop_size; individual++) {
         char buffer[1024];  // Increase size if necessary
         char *ptr = buffer; // Pointer for the buffer
 
         ptr += sprintf(ptr, ":%d: ", individual);
         for (int gene = 0; gene < MAX_GENES; gene++) {
-            ptr += sprintf(ptr, "%.2f,", population[individual][gene]);  // Using %.2f to format to 2 decimal places
+            ptr += sprintf(ptr, "%.2f,", geneValue(population[individual][gene]));  // Using %.2f to format to 2 decimal places
         }
         ptr += sprintf(ptr, " F: %.2f (inverted: %.6f)", true_f[individual], fitness[individual]);  // Format true fitness and inverted fitness
 
@@ -326,285 +1058,1401 @@ void print_population(void) {
 void print_ranking(void) {
     ESP_LOGI(TAG, "In rank order, 0 = worst, pop_size = best");
 
-    for (int r = 0; r < POP_SIZE; r++) {
+    for (int r = 0; r < s_pop_size; r++) {
         ESP_LOGI(TAG, "Rank %d, Individual %d (F: %.6f, inverted: %.6f)",
                  r, rank[r], true_f[rank[r]], fitness[rank[r]]);
     }
 }
 
+bool ga_get_best_snapshot(ga_best_snapshot_t *out) {
+    unsigned seq0, seq1;
+    int spins = 0;
+
+    for (;;) {
+        seq0 = atomic_load_explicit(&s_best_seq, memory_order_acquire);
+        if (!(seq0 & 1)) {
+            memcpy(out, &s_best, sizeof(*out));
+            atomic_thread_fence(memory_order_acquire);
+            seq1 = atomic_load_explicit(&s_best_seq, memory_order_relaxed);
+            if (seq0 == seq1) {
+                break;
+            }
+        }
+        // A reader that preempted the GA task mid-publish on the same
+        // core would spin forever, so back off after a few attempts.
+        if (++spins >= GA_SNAPSHOT_SPINS) {
+            vTaskDelay(1);
+            spins = 0;
+        }
+    }
+    return seq0 != 0;
+}
+
 float ga_get_local_best_fitness(void) {
-    return true_f[rank[POP_SIZE - 1]];
+    ga_best_snapshot_t snap;
+    if (!ga_get_best_snapshot(&snap)) {
+        return -1.0f;   // nothing published yet
+    }
+    return snap.fitness;
+}
+
+float ga_get_diversity(void) {
+    ga_best_snapshot_t snap;
+    if (!ga_get_best_snapshot(&snap)) {
+        return -1.0f;
+    }
+    return snap.diversity;
+}
+
+bool ga_diversity_collapsed(void) {
+    if (g_diversity_collapse <= 0.0f) {
+        return false;
+    }
+    float diversity = ga_get_diversity();
+    return diversity >= 0.0f && diversity < g_diversity_collapse;
 }
 
 void ga_integrate_remote_solution(const float *remote_genes)
 {   
-    //DEFAULT_GENE_OVERWRITE 5% of local population
-    int how_many = (int)(DEFAULT_GENE_OVERWRITE * POP_SIZE);
+    // Radio migrants go to the islands in turn, the ring spreads them on
+    ga_island_t *isl = &s_islands[s_remote_migrants++ % (uint32_t)s_num_islands];
+
+    //DEFAULT_GENE_OVERWRITE 5% of the island
+    int how_many = (int)(DEFAULT_GENE_OVERWRITE * isl->size);
     if (how_many <= 0) {
         how_many = 1; // ensure at least 1
     }
 
     //overwrite the worst k-individuals with remote genes
+    float genes[MAX_GENES];
+    ga_gene_t row[MAX_GENES];
+    memcpy(genes, remote_genes, sizeof(genes));
+    encodeRow(row, genes);
     for (int i = 0; i < how_many; i++) {
-        for (int gene = 0; gene < MAX_GENES; gene++) {
-            population[ rank[i] ][gene] = remote_genes[gene];
-        }
+        replaceRow(population[rank[isl->base + i]], row);
+        memcpy(population[rank[isl->base + i]], row, sizeof(row));
     }
+    markReplaced(isl, how_many);
 
     //recalculate the population fitness and ranking
     determineFitness();
-    createRanking();
+    updateIslandRanking(isl);
+    publishBest();
 }
 
-void evolve(void) {
-    // Apply Rastrigin to each candidate solution
-    // to determine their "fitness"
-    determineFitness();
-
-    // Rank outcomes - note that the array rank[]
-    // is sorted, which itself has the index of
-    // population[][]
-    createRanking();
-
-    // If hyper-mutation is active, decrement counter
-    if (s_hyper_mutation_active) {
-        s_hyper_mutation_generations--;
-        if (s_hyper_mutation_generations <= 0) {
-            s_hyper_mutation_active = false;
-            g_mutate_prob = s_base_mutation_prob;
-            //ESP_LOGI(TAG, "Hyper-mutation ended, revert to base mutation");
+// Ring migration: the best GA_ISLAND_MIGRANTS of island k replace the
+// worst of island k + 1, and the last island feeds island 0. Best rows
+// sit at the top of an island's rank[] slice and the rows they overwrite
+// at the bottom, so with GA_MIN_ISLAND_SIZE > 2 * GA_ISLAND_MIGRANTS the
+// copies can be made in place, one island after the other.
+static void migrateRing(void) {
+    for (int k = 0; k < s_num_islands; k++) {
+        const ga_island_t *from = &s_islands[k];
+        ga_island_t *to = &s_islands[(k + 1) % s_num_islands];
+        for (int m = 0; m < GA_ISLAND_MIGRANTS; m++) {
+            replaceRow(population[rank[to->base + m]], population[rank[islandTop(from) - m]]);
+            memcpy(population[rank[to->base + m]], population[rank[islandTop(from) - m]],
+                   sizeof(population[0]));
         }
+        markReplaced(to, GA_ISLAND_MIGRANTS);
     }
+    s_ring_migrations++;
 
-    // We need to create a new temporary population so that
-    // as we draw from the old population, we don't overwrite
-    // the information with new children.  For example, if we
-    // replace the worst population members with new children,
-    // there are instances when a worst member may be used to 
-    // generate a child.  Therefore, we don't want to 
-    // prematurely overwrite a worst member.
-    // Once we have a set of new children, we copy them back 
-    // into the main population.
-    
-    // How many children as a percentage of the population?
-    int how_many = (int)(POP_SIZE * PERCENT_CHILD);
-    // Create a new array of children
-    float children[how_many][MAX_GENES];
+    determineFitness();
+    updateRanking();
+}
 
-    // Generate 'how many' children
-    for (int i = 0; i < how_many; i++) {
+// Breed children first..last-1 of an island from its prepared selection
+// tables, drawing only from rng. Child i goes to row rank[base + i] of
+// the back buffer next[], the row it replaces, and its fitness to
+// s_child_f[base + i]. Reads the population but writes nothing another
+// range or island writes, so disjoint ranges can run on different cores.
+// Returns how many children beat their first parent.
+static int breedChildren(const ga_island_t *isl, ga_rng_t *rng, ga_gene_t (*next)[MAX_GENES], int first, int last) {
+    float sd = isl->sigma * s_sigma_boost;
+    int successes = 0;
+
+    for (int i = isl->base + first; i < isl->base + last; i++) {
+        float child[MAX_GENES];
         // Select a parent.
-        int parent1 = rouletteSelection();
+        int parent1 = (g_selection_mode == GA_SELECTION_SUS) ? s_sus_parents[i] : selectParent(isl, rng);
         // Recombination.  
         // Here, two parents are used to generate
         // a single child offspring.  Could be all
         // of parent1, all of parent2, or a mix.
         // All parent1 by default:
-        for (int gene = 0; gene < MAX_GENES; gene++) {
-            children[i][gene] = population[parent1][gene];
-        }
+        decodeRow(child, population[parent1]);
         // Do recombination?
-        if ((double)rand() / RAND_MAX < XOVER_PROB) {
+        if (ga_rng_uniform(rng) < XOVER_PROB) {
             // We need a second parent
-            int parent2 = rouletteSelection();
+            int parent2 = selectParent(isl, rng);
             // How much of parent2 to inherit?
             // Select a point along the genotype [ 0 : MAX_GENES ]
-            int xover = rand() % MAX_GENES;
+            int xover = (int)ga_rng_below(rng, MAX_GENES);
             for (int gene = xover; gene < MAX_GENES; gene++) {
-                children[i][gene] = population[parent2][gene];
+                child[gene] = geneValue(population[parent2][gene]);
             }
         } // end of xover
 
-        // Mutation, evaluated per gene
+        // Mutation, evaluated per gene. The gaussian noise for the
+        // whole genome is drawn in one go.
+        float noise[MAX_GENES];
+        ga_rng_fill_gaussian(rng, noise, MAX_GENES, MUTATE_MEAN, sd);
         for (int gene = 0; gene < MAX_GENES; gene++) {
-            if ((double)rand() / RAND_MAX <= g_mutate_prob) {
+            if (ga_rng_uniform(rng) <= g_mutate_prob) {
                 // +=, but can be +/- mutation
-                children[i][gene] += randGaussian(0.0, 0.05);
+                child[gene] += noise[gene];
                 // Limit range.  Another way would be to wrap around.
-                if (children[i][gene] > MAX_GENE_VALUE) children[i][gene] = MAX_GENE_VALUE;
-                if (children[i][gene] < MIN_GENE_VALUE) children[i][gene] = MIN_GENE_VALUE;
+                if (child[gene] > gene_max_value) child[gene] = gene_max_value;
+                if (child[gene] < gene_min_value) child[gene] = gene_min_value;
             }
         } // end of mutate
+        encodeRow(next[rank[i]], child);
+
+        // Evaluate here, while the genes are hot and on this core
+        GA_CLOCK_START(s_worker_clock);
+        s_child_f[i] = s_fitness_kernel(child);
+        GA_CLOCK_STOP(s_worker_clock, GA_PHASE_FITNESS);
+        if (s_child_f[i] < true_f[parent1]) {
+            successes++;
+        }
     } // Finished generating children
+    return successes;
+}
 
-    // Insert back into population by rank[0] (worst) up to 'how many'.
-    // Note, using rank[] which has sorted the index of the population
-    // into rank order, rank[0] is the index of the worst individual
-    // and rank[ pop_size -1 ] is the best individual.
-    // Therefore, this routine will copy children over the worst population
-    // members going up (improving) - keeping the current best solutions.
-    for (int i = 0; i < how_many; i++) {
-        // Per population member _i_, copy each gene across.
-        for (int gene = 0; gene < MAX_GENES; gene++) {
-            // Note, indexing population by the rank array.
-            // Note, the children generated are essentially 
-            // random so we don't care about a rank order for
-            // children.
-            population[rank[i]][gene] = children[i][gene];
-        }
+// 1/5th success rule on the generation just bred. Not while a
+// hyper-mutation boost is fading, its failures say nothing about sigma.
+static void adaptSigma(ga_island_t *isl, int how_many) {
+    isl->success_rate = how_many > 0 ? (float)isl->successes / how_many : 0.0f;
+    if (!g_adaptive_mutation || s_hyper_remaining > 0 || how_many <= 0) {
+        return;
     }
-}
 
-void init_ga(bool wifiAvailable) {
-    // Initialize the GA population
-    init_population(wifiAvailable);
-    s_base_mutation_prob = g_mutate_prob;
-    //print_population();
+    float range = gene_max_value - gene_min_value;
+    isl->sigma *= expf(GA_SIGMA_ADAPT_RATE * (isl->success_rate - GA_SIGMA_TARGET_SUCCESS)
+                       / (1.0f - GA_SIGMA_TARGET_SUCCESS));
+    if (isl->sigma < GA_SIGMA_MIN * range) isl->sigma = GA_SIGMA_MIN * range;
+    if (isl->sigma > GA_SIGMA_MAX * range) isl->sigma = GA_SIGMA_MAX * range;
 }
 
-static void ga_complete_callback(void)
-{
-    // drain the buffered ESPNOW messages
-    drain_buffered_messages();  
-    ga_has_run_before = true;
-    s_last_ga_time = (uint32_t)(esp_timer_get_time() / 1000ULL);
+// How many children as a percentage of the island?
+static inline int childCount(const ga_island_t *isl) {
+    return (int)(isl->size * PERCENT_CHILD);
 }
 
-//Task function that the main application can call
-void ga_task(void *pvParameters) {
-    if (LogQueue == NULL || LogBodyQueue == NULL) {
-        ESP_LOGW(TAG, "LogQueue or LogBodyQueue is NULL! Exiting GA task.");
-        xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT);
-        vTaskDelete(NULL);
-    }
-    float last_best_fitness = -1.0;  // Init impossible fitness value
-    float threshold = 0.01;  // Threshold for detecting significant changes in fitness
-    int no_improvement_count = 0;
-    int patience = DEFAULT_PATIENCE; // Stop if there are consecutive no-gain generations TODO: get reference
-    static bool start_logged = false;
-
-    while (1) {
-        time_t now = time(NULL);
-        
-        if (!start_logged) {
-            float current_best_fitness = true_f[rank[POP_SIZE - 1]];
+// Fitness is fixed for the rest of this generation, so the selection
+// tables are built once here rather than per draw.
+static void prepareBreeding(ga_island_t *isl) {
+    prepareIslandSelection(isl);
+    if (g_selection_mode == GA_SELECTION_SUS) {
+        susIslandSelection(isl, &isl->rng, s_sus_parents + isl->base, childCount(isl));
+    }
+}
 
-            event_log_t log_entry;
-            event_log_message_t log_body;
-
-            if (xSemaphoreTake(logCounterMutex, portMAX_DELAY)) {
-                log_counter++;
-                xSemaphoreGive(logCounterMutex);
+// Differential evolution, DE/rand/1/bin. Targets first..last-1 are the
+// rows rank[base + first ..]; each trial goes to its target's row of
+// next[] if it is no worse, the target is carried across if not. Same
+// contract as breedChildren(), returns how many trials were better.
+static int breedDifferential(const ga_island_t *isl, ga_rng_t *rng, ga_gene_t (*next)[MAX_GENES], int first, int last) {
+    int successes = 0;
+
+    for (int i = isl->base + first; i < isl->base + last; i++) {
+        int target = rank[i];
+        int a, b, c;
+        do { a = isl->base + (int)ga_rng_below(rng, isl->size); } while (a == target);
+        do { b = isl->base + (int)ga_rng_below(rng, isl->size); } while (b == target || b == a);
+        do { c = isl->base + (int)ga_rng_below(rng, isl->size); } while (c == target || c == a || c == b);
+
+        float trial[MAX_GENES];
+        int forced = (int)ga_rng_below(rng, MAX_GENES);
+        for (int gene = 0; gene < MAX_GENES; gene++) {
+            if (gene == forced || ga_rng_uniform(rng) < GA_DE_CR) {
+                trial[gene] = geneValue(population[a][gene]) +
+                              GA_DE_F * (geneValue(population[b][gene]) - geneValue(population[c][gene]));
+                if (trial[gene] > gene_max_value) trial[gene] = gene_max_value;
+                if (trial[gene] < gene_min_value) trial[gene] = gene_min_value;
+            } else {
+                trial[gene] = geneValue(population[target][gene]);
             }
+        }
+        encodeRow(next[target], trial);
+
+        GA_CLOCK_START(s_worker_clock);
+        float f = s_fitness_kernel(trial);
+        GA_CLOCK_STOP(s_worker_clock, GA_PHASE_FITNESS);
+        if (f <= true_f[target]) {
+            s_child_f[i] = f;
+            if (f < true_f[target]) {
+                successes++;
+            }
+        } else {
+            memcpy(next[target], population[target], sizeof(next[0]));
+            s_child_f[i] = true_f[target];
+        }
+    }
+    return successes;
+}
 
-            log_entry.log_id = log_counter;
-            log_entry.log_datetime = now;
-            strcpy(log_entry.status, "T"); 
-            strcpy(log_entry.tag, "G"); 
-            strcpy(log_entry.log_level, "I");
-            strcpy(log_entry.log_type, "S"); // <--- S for start
-            strcpy(log_entry.from_id, "");
-            xQueueSend(LogQueue, &log_entry, portMAX_DELAY);
-
-            int offset = 0;
-            log_body.log_id = log_counter;
-            log_body.log_datetime = now;
-            offset += sprintf(log_body.log_message + offset, "%.3f|", current_best_fitness);
-            for (int gene = 0; gene < MAX_GENES; gene++) {
-                offset += sprintf(log_body.log_message + offset, "%.3f|", population[rank[POP_SIZE - 1]][gene]);
+// Recombination weight of the i-th best of mu, not normalised.
+static inline float cmaWeight(int mu, int i) {
+    return logf((float)mu + 0.5f) - logf((float)i + 1.0f);
+}
+
+// sep-CMA-ES update from the island's current rows, best first in its
+// rank[] slice: new mean, evolution paths, diagonal covariance (rank-one
+// plus rank-mu) and cumulative step size adaptation. Runs before the
+// island is resampled, so migrants and remote solutions written into it
+// since the last generation take part like any other sample.
+static void cmaUpdate(ga_island_t *isl) {
+    ga_cma_t *cma = &s_cma[isl - s_islands];
+    const float n = (float)MAX_GENES;
+    const int mu = isl->size / 2;
+    const int top = islandTop(isl);
+    float range = gene_max_value - gene_min_value;
+
+    float wsum = 0.0f, w2sum = 0.0f;
+    for (int i = 0; i < mu; i++) {
+        float w = cmaWeight(mu, i);
+        wsum += w;
+        w2sum += w * w;
+    }
+    float mueff = wsum * wsum / w2sum;
+    float cs = (mueff + 2.0f) / (n + mueff + 3.0f);
+    float damps = 1.0f + 2.0f * fmaxf(0.0f, sqrtf((mueff - 1.0f) / (n + 1.0f)) - 1.0f) + cs;
+    float cc = 4.0f / (n + 4.0f);
+    float ccov = (n + 2.0f) / 3.0f *
+                 (2.0f / ((n + 1.41421356f) * (n + 1.41421356f)) / mueff +
+                  (1.0f - 1.0f / mueff) * fminf(1.0f, (2.0f * mueff - 1.0f) / ((n + 2.0f) * (n + 2.0f) + mueff)));
+    float chi_n = sqrtf(n) * (1.0f - 1.0f / (4.0f * n) + 1.0f / (21.0f * n * n));
+
+    float old_mean[MAX_GENES];
+    float rank_mu[MAX_GENES];
+    memcpy(old_mean, cma->mean, sizeof(old_mean));
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        cma->mean[gene] = 0.0f;
+        rank_mu[gene] = 0.0f;
+    }
+    for (int i = 0; i < mu; i++) {
+        float x[MAX_GENES];
+        decodeRow(x, population[rank[top - i]]);
+        float w = cmaWeight(mu, i) / wsum;
+        for (int gene = 0; gene < MAX_GENES; gene++) {
+            float d = (x[gene] - old_mean[gene]) / cma->sigma;
+            cma->mean[gene] += w * x[gene];
+            rank_mu[gene] += w * d * d;
+        }
+    }
+
+    float ks = sqrtf(cs * (2.0f - cs) * mueff);
+    float ps_norm = 0.0f;
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float step = (cma->mean[gene] - old_mean[gene]) / cma->sigma;
+        cma->ps[gene] = (1.0f - cs) * cma->ps[gene] + ks * step / sqrtf(cma->diag_c[gene]);
+        ps_norm += cma->ps[gene] * cma->ps[gene];
+    }
+    ps_norm = sqrtf(ps_norm);
+    cma->updates++;
+
+    // Stall the covariance path while the step size path is long
+    bool hsig = ps_norm / sqrtf(1.0f - powf(1.0f - cs, 2.0f * (float)cma->updates)) / chi_n
+                < 1.4f + 2.0f / (n + 1.0f);
+    float kc = hsig ? sqrtf(cc * (2.0f - cc) * mueff) : 0.0f;
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float step = (cma->mean[gene] - old_mean[gene]) / cma->sigma;
+        cma->pc[gene] = (1.0f - cc) * cma->pc[gene] + kc * step;
+        cma->diag_c[gene] = (1.0f - ccov) * cma->diag_c[gene]
+                            + ccov / mueff * cma->pc[gene] * cma->pc[gene]
+                            + ccov * (1.0f - 1.0f / mueff) * rank_mu[gene];
+        if (cma->diag_c[gene] < 1.0e-12f) cma->diag_c[gene] = 1.0e-12f;
+    }
+
+    cma->sigma *= expf((cs / damps) * (ps_norm / chi_n - 1.0f));
+    if (cma->sigma < GA_SIGMA_MIN * range) cma->sigma = GA_SIGMA_MIN * range;
+    if (cma->sigma > GA_CMA_SIGMA_MAX * range) cma->sigma = GA_CMA_SIGMA_MAX * range;
+}
+
+// Resample the rows rank[base + first ..] from the island's distribution,
+// clamped to the gene range like a mutation. Same contract as
+// breedChildren(), returns how many samples beat the island's best.
+static int breedCma(const ga_island_t *isl, ga_rng_t *rng, ga_gene_t (*next)[MAX_GENES], int first, int last) {
+    const ga_cma_t *cma = &s_cma[isl - s_islands];
+    float scale[MAX_GENES];
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        scale[gene] = cma->sigma * sqrtf(cma->diag_c[gene]);
+    }
+    float best = true_f[rank[islandTop(isl)]];
+    int successes = 0;
+
+    for (int i = isl->base + first; i < isl->base + last; i++) {
+        float x[MAX_GENES];
+        ga_rng_fill_gaussian(rng, x, MAX_GENES, 0.0f, 1.0f);
+        for (int gene = 0; gene < MAX_GENES; gene++) {
+            x[gene] = cma->mean[gene] + scale[gene] * x[gene];
+            if (x[gene] > gene_max_value) x[gene] = gene_max_value;
+            if (x[gene] < gene_min_value) x[gene] = gene_min_value;
+        }
+        encodeRow(next[rank[i]], x);
+        GA_CLOCK_START(s_worker_clock);
+        s_child_f[i] = s_fitness_kernel(x);
+        GA_CLOCK_STOP(s_worker_clock, GA_PHASE_FITNESS);
+        if (s_child_f[i] < best) {
+            successes++;
+        }
+    }
+    return successes;
+}
+
+static inline int islandSize(const ga_island_t *isl) {
+    return isl->size;
+}
+
+// Every row but the island's best, which is carried across.
+static inline int cmaCount(const ga_island_t *isl) {
+    return isl->size - 1;
+}
+
+static void recordSuccess(ga_island_t *isl, int how_many) {
+    isl->success_rate = how_many > 0 ? (float)isl->successes / how_many : 0.0f;
+}
+
+// What evolve() needs from an optimiser. Each generation an island's
+// prepare() runs first, then breed() fills the rows of the bottom
+// count() slots of its rank[] slice in the back buffer and their fitness
+// in s_child_f[] (disjoint ranges may run on different cores), the rows
+// above are carried across, and finish() sees the result.
+typedef struct {
+    const char *name;
+    void (*prepare)(ga_island_t *isl);  // may be NULL
+    int (*breed)(const ga_island_t *isl, ga_rng_t *rng, ga_gene_t (*next)[MAX_GENES], int first, int last);
+    int (*count)(const ga_island_t *isl);
+    void (*finish)(ga_island_t *isl, int how_many);
+} ga_engine_ops_t;
+
+static const ga_engine_ops_t s_engines[GA_ENGINE_COUNT] = {
+    [GA_ENGINE_GA]      = { "GA",      prepareBreeding, breedChildren,     childCount, adaptSigma },
+    [GA_ENGINE_DE]      = { "DE",      NULL,            breedDifferential, islandSize, recordSuccess },
+    [GA_ENGINE_SEP_CMA] = { "SEP_CMA", cmaUpdate,       breedCma,          cmaCount,   recordSuccess },
+};
+
+const char *ga_engine_name(int engine) {
+    if (engine < 0 || engine >= GA_ENGINE_COUNT) {
+        return NULL;
+    }
+    return s_engines[engine].name;
+}
+
+typedef struct {
+    ga_gene_t (*next)[MAX_GENES];
+    int how_many;
+    int successes[GA_PARALLEL_WORKERS];
+} ga_breed_job_t;
+
+static void prepareIsland(const ga_engine_ops_t *engine, ga_island_t *isl) {
+    if (engine->prepare != NULL) {
+        GA_CLOCK_START(s_worker_clock);
+        engine->prepare(isl);
+        GA_CLOCK_STOP(s_worker_clock, GA_PHASE_SELECTION);
+    }
+}
+
+// ga_parallel_run() body for a single island: worker 0 (GA task) breeds
+// the first half with island 0's generator, worker 1 (helper) the second
+// half with its own stream.
+static void breedWorker(void *arg, int worker) {
+    ga_breed_job_t *job = (ga_breed_job_t *)arg;
+    const ga_engine_ops_t *engine = &s_engines[s_engine_id];
+    int split = job->how_many / GA_PARALLEL_WORKERS;
+
+    if (worker == 0) {
+        job->successes[0] = engine->breed(&s_islands[0], &s_islands[0].rng, job->next, 0, split);
+    } else {
+        job->successes[1] = engine->breed(&s_islands[0], &s_helper_rng, job->next, split, job->how_many);
+    }
+}
+
+// ga_parallel_run() body for several islands: each worker takes every
+// GA_PARALLEL_WORKERS-th island, breeding it whole from its own generator.
+static void islandWorker(void *arg, int worker) {
+    ga_breed_job_t *job = (ga_breed_job_t *)arg;
+    const ga_engine_ops_t *engine = &s_engines[s_engine_id];
+
+    for (int k = worker; k < s_num_islands; k += GA_PARALLEL_WORKERS) {
+        ga_island_t *isl = &s_islands[k];
+        prepareIsland(engine, isl);
+        isl->successes = engine->breed(isl, &isl->rng, job->next, 0, engine->count(isl));
+    }
+}
+
+// (1+1)-ES on the best GA_LOCAL_SEARCH_TOP_K rows of an island, taking
+// them in turn for budget evaluations. Rows are improved in place, so they
+// only move up past each other: re-sorting the top slots is enough.
+static void localSearchIsland(ga_island_t *isl, int budget) {
+    int k = (GA_LOCAL_SEARCH_TOP_K < isl->size) ? GA_LOCAL_SEARCH_TOP_K : isl->size;
+    int top = islandTop(isl);
+    float range = gene_max_value - gene_min_value;
+    bool improved = false;
+
+    for (int e = 0; e < budget; e++) {
+        int row = rank[top - e % k];
+        float candidate[MAX_GENES];
+        ga_gene_t encoded[MAX_GENES];
+        ga_rng_fill_gaussian(&isl->rng, candidate, MAX_GENES, 0.0f, s_ls_stats.step);
+        for (int gene = 0; gene < MAX_GENES; gene++) {
+            candidate[gene] += geneValue(population[row][gene]);
+            if (candidate[gene] > gene_max_value) candidate[gene] = gene_max_value;
+            if (candidate[gene] < gene_min_value) candidate[gene] = gene_min_value;
+        }
+        encodeRow(encoded, candidate);
+
+        float f = s_fitness_kernel(candidate);
+        if (f < true_f[row]) {
+            s_ls_stats.gain += true_f[row] - f;
+            s_ls_stats.improvements++;
+            replaceRow(population[row], encoded);
+            memcpy(population[row], encoded, sizeof(encoded));
+            storeFitness(row, f);
+            s_ls_stats.step *= expf(1.0f / 3.0f);
+            improved = true;
+        } else {
+            s_ls_stats.step *= expf(-1.0f / 12.0f);
+        }
+        if (s_ls_stats.step < GA_SIGMA_MIN * range) s_ls_stats.step = GA_SIGMA_MIN * range;
+        if (s_ls_stats.step > GA_SIGMA_MAX * range) s_ls_stats.step = GA_SIGMA_MAX * range;
+    }
+    s_ls_stats.evaluations += budget;
+    s_fitness_stats.evaluated += budget;
+
+    if (improved) {
+        for (int i = top - k + 2; i <= top; i++) {
+            int row = rank[i];
+            int j = i;
+            while (j > top - k + 1 && fitness[rank[j - 1]] > fitness[row]) {
+                rank[j] = rank[j - 1];
+                j--;
             }
-            if (LogBodyQueue == NULL) {
-                ESP_LOGW(TAG, "LogBodyQueue is NULL! Exiting GA task.");
-                xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT);
-                vTaskDelete(NULL);
+            rank[j] = row;
+        }
+        isl->selection_ready = false;
+    }
+}
+
+// Memetic stage, see GA_LOCAL_SEARCH. rank[] must be sorted; it still is
+// afterwards. The budget is shared between the islands.
+static void localSearch(void) {
+    float best = true_f[bestRow()];
+    ga_stagnation_update(&s_ls_stall, best);
+    if (g_local_search == GA_LOCAL_SEARCH_OFF || g_local_search_budget <= 0) {
+        return;
+    }
+    if (g_local_search == GA_LOCAL_SEARCH_ON_STALL && !ga_stagnated(&s_ls_stall)) {
+        return;
+    }
+
+    int64_t t0 = esp_timer_get_time();
+    int share = g_local_search_budget / s_num_islands;
+    if (share < 1) {
+        share = 1;
+    }
+    for (int k = 0; k < s_num_islands; k++) {
+        localSearchIsland(&s_islands[k], share);
+    }
+    s_ls_stats.best_gain += best - true_f[bestRow()];
+    s_ls_stats.generations++;
+    s_ls_stats.time_us += (uint64_t)(esp_timer_get_time() - t0);
+}
+
+void evolve(void) {
+    GA_CLOCK_DECLARE(clock);
+
+    // Apply the fitness function to each candidate solution
+    // to determine their "fitness"
+    GA_CLOCK_START(clock);
+    determineFitness();
+    GA_CLOCK_STOP(clock, GA_PHASE_FITNESS);
+
+    // Rank outcomes - note that the array rank[]
+    // is sorted, which itself has the index of
+    // population[][]. Only the children written
+    // last generation need to be re-sorted.
+    GA_CLOCK_START(clock);
+    updateRanking();
+    GA_CLOCK_STOP(clock, GA_PHASE_RANKING);
+
+    // Refine the elites before they are published and bred from
+    localSearch();
+
+    // The best row survives the children below, so this generation's
+    // best can be published now.
+    s_generation++;
+    if (s_generation % GA_DIVERSITY_REFRESH == 0) {
+        measureGeneSpread(s_gene_mean, s_gene_m2);
+    }
+    publishBest();
+    if (s_best_history != NULL) {
+        s_best_history[s_history_count++ % GA_HISTORY_LEN] = true_f[bestRow()];
+    }
+
+    // Islands swap their best around the ring every so often. Copies of
+    // the best cannot change the overall best, which is already published.
+    if (s_num_islands > 1 && g_island_migration_interval > 0 &&
+        s_generation % (uint32_t)g_island_migration_interval == 0) {
+        migrateRing();
+    }
+
+    // Graded hyper-mutation fades out on its own, the on/off kind
+    // counts down the same s_hyper_remaining
+    if (g_adaptive_mutation) {
+        applyHyperMutation();
+    } else if (s_hyper_mutation_active) {
+        s_hyper_remaining--;
+        if (s_hyper_remaining <= 0) {
+            s_hyper_mutation_active = false;
+            g_mutate_prob = s_base_mutation_prob;
+            //ESP_LOGI(TAG, "Hyper-mutation ended, revert to base mutation");
+        }
+    }
+
+    // We need to create a new population so that
+    // as we draw from the old population, we don't overwrite
+    // the information with new children.  For example, if we
+    // replace the worst population members with new children,
+    // there are instances when a worst member may be used to 
+    // generate a child.  Therefore, we don't want to 
+    // prematurely overwrite a worst member.
+    // Children are written into the back buffer of the
+    // ping-pong pair, the elites are carried across, and
+    // the buffers swap.
+    const ga_engine_ops_t *engine = &s_engines[s_engine_id];
+    ga_gene_t (*next)[MAX_GENES] = s_pop_buf[s_pop_front ^ 1];
+    ga_breed_job_t job = { next, engine->count(&s_islands[0]), { 0 } };
+
+    // Generate 'how many' children per island, evaluated as they are
+    // made. Each island draws from its own generator, so islands give the
+    // same run whichever core breeds them. A single island can instead be
+    // split between its generator and s_helper_rng, which is repeatable
+    // whether or not the helper task is actually running.
+    GA_CLOCK_RESET(s_worker_clock);
+    GA_CLOCK_START(clock);
+    if (s_num_islands == 1 && g_parallel_evolve) {
+        prepareIsland(engine, &s_islands[0]);
+        ga_parallel_run(breedWorker, &job);
+        s_islands[0].successes = job.successes[0] + job.successes[1];
+    } else if (g_parallel_evolve) {
+        ga_parallel_run(islandWorker, &job);
+    } else {
+        for (int worker = 0; worker < GA_PARALLEL_WORKERS; worker++) {
+            islandWorker(&job, worker);
+        }
+    }
+    GA_CLOCK_STOP(clock, GA_PHASE_BREED);
+#if GA_PROFILE
+    // Move this task's evaluation and selection time out of breeding
+    clock.cycles[GA_PHASE_BREED] -= s_worker_clock.cycles[GA_PHASE_FITNESS] + s_worker_clock.cycles[GA_PHASE_SELECTION];
+    clock.cycles[GA_PHASE_FITNESS] += s_worker_clock.cycles[GA_PHASE_FITNESS];
+    clock.cycles[GA_PHASE_SELECTION] += s_worker_clock.cycles[GA_PHASE_SELECTION];
+#endif
+
+    // Children went to the rows indexed by the bottom 'how many' slots of
+    // each island's rank[] slice, and the top slot is the island's best
+    // individual. The rows above the children are the elites: copy them
+    // across unchanged, keeping the current best solutions, then swap the
+    // buffers.
+    GA_CLOCK_START(clock);
+    for (int k = 0; k < s_num_islands; k++) {
+        ga_island_t *isl = &s_islands[k];
+        int how_many = engine->count(isl);
+        for (int i = isl->base; i < isl->base + how_many; i++) {
+            replaceRow(population[rank[i]], next[rank[i]]);
+        }
+        for (int i = isl->base + how_many; i <= islandTop(isl); i++) {
+            memcpy(next[rank[i]], population[rank[i]], sizeof(next[0]));
+        }
+    }
+    s_pop_front ^= 1;
+    population = next;
+
+    // The children arrive evaluated, so the next determineFitness()
+    // only has migrants and mass extinction rows left to do.
+    for (int k = 0; k < s_num_islands; k++) {
+        ga_island_t *isl = &s_islands[k];
+        int how_many = engine->count(isl);
+        markReplaced(isl, how_many);
+        for (int i = isl->base; i < isl->base + how_many; i++) {
+            storeFitness(rank[i], s_child_f[i]);
+        }
+        s_children_evaluated += how_many;
+        s_fitness_stats.evaluated += how_many;
+        isl->selection_ready = false;
+        engine->finish(isl, how_many);
+    }
+    if (s_engine_id == GA_ENGINE_GA && g_adaptive_mutation && s_hyper_remaining <= 0) {
+        s_sigma_updates++;
+    }
+    GA_CLOCK_STOP(clock, GA_PHASE_COPY_BACK);
+
+    GA_CLOCK_RECORD(clock, GA_PHASE_FITNESS);
+    GA_CLOCK_RECORD(clock, GA_PHASE_RANKING);
+    GA_CLOCK_RECORD(clock, GA_PHASE_SELECTION);
+    GA_CLOCK_RECORD(clock, GA_PHASE_BREED);
+    GA_CLOCK_RECORD(clock, GA_PHASE_COPY_BACK);
+}
+
+int ga_population_size(void) {
+    return s_pop_size;
+}
+
+int ga_island_count(void) {
+    return s_num_islands;
+}
+
+float ga_get_island_best_fitness(int island) {
+    if (island < 0 || island >= s_num_islands || s_arena == NULL) {
+        return -1.0f;
+    }
+    return true_f[rank[islandTop(&s_islands[island])]];
+}
+
+uint32_t ga_get_ring_migrations(void) {
+    return s_ring_migrations;
+}
+
+int ga_get_best_history(float *out, int max_count) {
+    if (s_best_history == NULL) {
+        return 0;
+    }
+    int count = s_history_count < GA_HISTORY_LEN ? (int)s_history_count : GA_HISTORY_LEN;
+    if (count > max_count) {
+        count = max_count;
+    }
+    // Newest count entries, oldest first
+    uint32_t first = s_history_count - (uint32_t)count;
+    for (int i = 0; i < count; i++) {
+        out[i] = s_best_history[(first + (uint32_t)i) % GA_HISTORY_LEN];
+    }
+    return count;
+}
+
+float ga_evaluate(const float *genes) {
+    return s_fitness_kernel(genes);
+}
+
+// Switch the GA to the registry entry g_fitness_function names.
+static esp_err_t selectFitnessFunction(void) {
+    const ga_fitness_function_t *fn = ga_fitness_lookup(g_fitness_function);
+    if (fn == NULL) {
+        ESP_LOGE(TAG, "Unknown fitness function %d", g_fitness_function);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    fitness_function = fn->name;
+    gene_min_value = fn->min_gene;
+    gene_max_value = fn->max_gene;
+    s_fitness_kernel = fn->kernel;
+    s_gene_mid = 0.5f * (fn->min_gene + fn->max_gene);
+    s_gene_step = (fn->max_gene - fn->min_gene) / (2.0f * GA_GENE_QMAX);
+    s_gene_inv_step = 1.0f / s_gene_step;
+    s_mutate_sd = (float)(MUTATE_WIDTH * ((fn->max_gene - fn->min_gene) / (float)MUTATE_WIDTH_RANGE));
+    ESP_LOGI(TAG, "Fitness function %s over [%.3f, %.3f]", fn->name, fn->min_gene, fn->max_gene);
+    return ESP_OK;
+}
+
+// Switch to the optimiser g_ga_engine names.
+static esp_err_t selectEngine(void) {
+    const char *name = ga_engine_name(g_ga_engine);
+    if (name == NULL) {
+        ESP_LOGE(TAG, "Unknown optimiser engine %d", g_ga_engine);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_engine_id = g_ga_engine;
+    ga_engine = name;
+    ESP_LOGI(TAG, "Optimiser engine %s", name);
+    return ESP_OK;
+}
+
+// Size and lay out the GA for the g_ settings, leaving the rows to
+// init_population() or a checkpoint.
+static esp_err_t setupGa(void) {
+    esp_err_t err = selectFitnessFunction();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = selectEngine();
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = allocArena(g_pop_size);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = layoutIslands(s_pop_size, g_num_islands);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+#if GA_PROFILE
+    memset(s_phase_stats, 0, sizeof(s_phase_stats));
+    memset(s_phase_window, 0, sizeof(s_phase_window));
+#endif
+    return ESP_OK;
+}
+
+// Restore the newest stored checkpoint, if there is a usable one.
+static esp_err_t resumeFromCheckpoint(void) {
+    void *blob = NULL;
+    size_t len = 0;
+    esp_err_t err = ga_checkpoint_load(&blob, &len);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "No checkpoint to resume from: %s", esp_err_to_name(err));
+        return err;
+    }
+    err = ga_checkpoint_restore(blob, len);
+    heap_caps_free(blob);
+    return err;
+}
+
+esp_err_t init_ga(bool wifiAvailable) {
+    // Warm start: no seed fetch, no random population
+    if (g_ga_resume && resumeFromCheckpoint() == ESP_OK) {
+        return ESP_OK;
+    }
+    ga_resumed_generation = 0;
+    s_ckpt_stats.resumed_generation = 0;
+
+    esp_err_t err = setupGa();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // Initialize the GA population
+    init_population(wifiAvailable);
+    s_base_mutation_prob = g_mutate_prob;
+    //print_population();
+    return ESP_OK;
+}
+
+// Fixed part of a checkpoint. The rows follow it: population[pop_size]
+// [MAX_GENES], true_f[pop_size], rank[pop_size], then one dirty flag per
+// row. fitness[] is rebuilt from true_f[], the selection tables and the
+// incremental diversity from the rows.
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t max_genes;
+    uint16_t gene_bytes;        // sizeof(ga_gene_t)
+    int32_t pop_size;
+    int32_t num_islands;
+    int32_t engine;
+    int32_t fitness_function;
+    uint32_t generation;
+    uint16_t seed;
+    bool hyper_mutation_active;
+    int32_t hyper_mutation_generations;
+    int32_t hyper_level;
+    int32_t hyper_remaining;
+    float hyper_last_best;
+    float sigma_boost;
+    float base_mutation_prob;
+    float mutate_prob;
+    uint32_t sigma_updates;
+    uint32_t remote_migrants;
+    uint32_t ring_migrations;
+    int32_t children_evaluated;
+    ga_fitness_stats_t fitness_stats;
+    ga_local_search_stats_t ls_stats;
+    ga_stagnation_t ls_stall;
+    ga_rng_t helper_rng;
+    ga_island_t islands[GA_MAX_ISLANDS];
+    ga_cma_t cma[GA_MAX_ISLANDS];
+} ga_checkpoint_t;
+
+#define GA_CHECKPOINT_MAGIC 0x50434147u // "GACP"
+
+static size_t checkpointSize(int n) {
+    return sizeof(ga_checkpoint_t) + (size_t)n * (sizeof(population[0]) + sizeof(float) + sizeof(int) + sizeof(bool));
+}
+
+size_t ga_checkpoint_size(void) {
+    return checkpointSize(s_pop_size);
+}
+
+size_t ga_checkpoint_encode(void *buf, size_t len) {
+    size_t size = checkpointSize(s_pop_size);
+    if (s_arena == NULL || len < size) {
+        return 0;
+    }
+
+    ga_checkpoint_t *ckpt = buf;
+    memset(ckpt, 0, sizeof(*ckpt));
+    ckpt->magic = GA_CHECKPOINT_MAGIC;
+    ckpt->version = GA_CHECKPOINT_VERSION;
+    ckpt->max_genes = MAX_GENES;
+    ckpt->gene_bytes = sizeof(ga_gene_t);
+    ckpt->pop_size = s_pop_size;
+    ckpt->num_islands = s_num_islands;
+    ckpt->engine = s_engine_id;
+    ckpt->fitness_function = g_fitness_function;
+    ckpt->generation = s_generation;
+    ckpt->seed = seed;
+    ckpt->hyper_mutation_active = s_hyper_mutation_active;
+    ckpt->hyper_mutation_generations = s_hyper_mutation_generations;
+    ckpt->hyper_level = s_hyper_level;
+    ckpt->hyper_remaining = s_hyper_remaining;
+    ckpt->hyper_last_best = s_hyper_last_best;
+    ckpt->sigma_boost = s_sigma_boost;
+    ckpt->base_mutation_prob = s_base_mutation_prob;
+    ckpt->mutate_prob = g_mutate_prob;
+    ckpt->sigma_updates = s_sigma_updates;
+    ckpt->remote_migrants = s_remote_migrants;
+    ckpt->ring_migrations = s_ring_migrations;
+    ckpt->children_evaluated = s_children_evaluated;
+    ckpt->fitness_stats = s_fitness_stats;
+    ckpt->ls_stats = s_ls_stats;
+    ckpt->ls_stall = s_ls_stall;
+    ckpt->helper_rng = s_helper_rng;
+    memcpy(ckpt->islands, s_islands, sizeof(ckpt->islands));
+    memcpy(ckpt->cma, s_cma, sizeof(ckpt->cma));
+
+    uint8_t *at = (uint8_t *)(ckpt + 1);
+    memcpy(at, population, (size_t)s_pop_size * sizeof(population[0]));
+    at += (size_t)s_pop_size * sizeof(population[0]);
+    memcpy(at, true_f, (size_t)s_pop_size * sizeof(float));
+    at += (size_t)s_pop_size * sizeof(float);
+    memcpy(at, rank, (size_t)s_pop_size * sizeof(int));
+    at += (size_t)s_pop_size * sizeof(int);
+    memcpy(at, s_fitness_dirty, (size_t)s_pop_size * sizeof(bool));
+    return size;
+}
+
+// Check the checkpoint's islands are the ones layoutIslands() would build
+// for its population, and that each island's rank[] slice is a permutation
+// of its own rows, before anything of the running GA is touched.
+static esp_err_t checkCheckpointLayout(const ga_checkpoint_t *ckpt, const int *ranks) {
+    int n = ckpt->pop_size, count = ckpt->num_islands;
+    if (count < 1 || count > GA_MAX_ISLANDS || n / count < GA_MIN_ISLAND_SIZE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (ga_fitness_lookup(ckpt->fitness_function) == NULL || ga_engine_name(ckpt->engine) == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool *seen = heap_caps_calloc(n, sizeof(bool), MALLOC_CAP_DEFAULT);
+    if (seen == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = ESP_OK;
+    int base = 0;
+    for (int k = 0; err == ESP_OK && k < count; k++) {
+        const ga_island_t *isl = &ckpt->islands[k];
+        int size = n / count + (k < n % count ? 1 : 0);
+        if (isl->base != base || isl->size != size || isl->unranked < 0 || isl->unranked > size) {
+            err = ESP_ERR_INVALID_STATE;
+        }
+        for (int i = base; err == ESP_OK && i < base + size; i++) {
+            if (ranks[i] < base || ranks[i] >= base + size || seen[ranks[i]]) {
+                err = ESP_ERR_INVALID_STATE;
+            } else {
+                seen[ranks[i]] = true;
             }
-            xQueueSend(LogBodyQueue, &log_body, portMAX_DELAY);
+        }
+        base += size;
+    }
+    heap_caps_free(seen);
+    return err;
+}
+
+esp_err_t ga_checkpoint_restore(const void *buf, size_t len) {
+    const ga_checkpoint_t *ckpt = buf;
+    if (len < sizeof(*ckpt) || ckpt->magic != GA_CHECKPOINT_MAGIC) {
+        ESP_LOGW(TAG, "Not a GA checkpoint");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ckpt->version != GA_CHECKPOINT_VERSION || ckpt->max_genes != MAX_GENES ||
+        ckpt->gene_bytes != sizeof(ga_gene_t)) {
+        ESP_LOGW(TAG, "Checkpoint version %u with %u genes of %u bytes, this firmware reads version %d with %d of %u",
+                 ckpt->version, ckpt->max_genes, ckpt->gene_bytes, GA_CHECKPOINT_VERSION, MAX_GENES,
+                 (unsigned)sizeof(ga_gene_t));
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (ckpt->pop_size < 2 || len != checkpointSize(ckpt->pop_size)) {
+        ESP_LOGW(TAG, "Checkpoint of %u bytes does not hold %d individuals", (unsigned)len, (int)ckpt->pop_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint8_t *at = (const uint8_t *)(ckpt + 1);
+    const ga_gene_t (*rows)[MAX_GENES] = (const void *)at;
+    at += (size_t)ckpt->pop_size * sizeof(population[0]);
+    const float *f = (const void *)at;
+    at += (size_t)ckpt->pop_size * sizeof(float);
+    const int *ranks = (const void *)at;
+    at += (size_t)ckpt->pop_size * sizeof(int);
+    const bool *dirty = (const void *)at;
+
+    // A rejected checkpoint leaves the running GA as it was
+    esp_err_t err = checkCheckpointLayout(ckpt, ranks);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Cannot restore checkpoint: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // The checkpoint's settings replace the g_ ones. Only the arena
+    // allocation can fail from here on.
+    int pop_size = g_pop_size, num_islands = g_num_islands;
+    int fitness_id = g_fitness_function, engine = g_ga_engine;
+    g_pop_size = ckpt->pop_size;
+    g_num_islands = ckpt->num_islands;
+    g_fitness_function = ckpt->fitness_function;
+    g_ga_engine = ckpt->engine;
+    err = setupGa();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Cannot restore checkpoint: %s", esp_err_to_name(err));
+        g_pop_size = pop_size;
+        g_num_islands = num_islands;
+        g_fitness_function = fitness_id;
+        g_ga_engine = engine;
+        return err;
+    }
+
+    memcpy(s_islands, ckpt->islands, sizeof(s_islands));
+    memcpy(s_cma, ckpt->cma, sizeof(s_cma));
+    for (int k = 0; k < s_num_islands; k++) {
+        s_islands[k].selection_ready = false;
+    }
+    s_helper_rng = ckpt->helper_rng;
+    seed = ckpt->seed;
+    s_hyper_mutation_active = ckpt->hyper_mutation_active;
+    s_hyper_mutation_generations = ckpt->hyper_mutation_generations;
+    s_hyper_level = ckpt->hyper_level;
+    s_hyper_remaining = ckpt->hyper_remaining;
+    s_hyper_last_best = ckpt->hyper_last_best;
+    s_sigma_boost = ckpt->sigma_boost;
+    s_base_mutation_prob = ckpt->base_mutation_prob;
+    g_mutate_prob = ckpt->mutate_prob;
+    s_sigma_updates = ckpt->sigma_updates;
+    s_remote_migrants = ckpt->remote_migrants;
+    s_ring_migrations = ckpt->ring_migrations;
+    s_children_evaluated = ckpt->children_evaluated;
+    s_fitness_stats = ckpt->fitness_stats;
+    s_ls_stats = ckpt->ls_stats;
+    s_ls_stall = ckpt->ls_stall;
+
+    s_pop_front = 0;
+    population = s_pop_buf[0];
+    memcpy(population, rows, (size_t)s_pop_size * sizeof(population[0]));
+    for (int row = 0; row < s_pop_size; row++) {
+        storeFitness(row, f[row]);
+        s_fitness_dirty[row] = dirty[row];
+    }
+    memcpy(rank, ranks, (size_t)s_pop_size * sizeof(int));
+
+    measureGeneSpread(s_gene_mean, s_gene_m2);
+    s_generation = ckpt->generation;
+    publishBest();
+
+    ga_resumed_generation = s_generation;
+    s_ckpt_stats.resumed_generation = s_generation;
+    ESP_LOGI(TAG, "Resumed %s/%s at generation %u, %d individuals in %d islands, best %.3f",
+             ga_engine, fitness_function, (unsigned)s_generation, s_pop_size, s_num_islands,
+             true_f[bestRow()]);
+    return ESP_OK;
+}
+
+esp_err_t ga_checkpoint_save(void) {
+    int64_t t0 = esp_timer_get_time();
+    size_t size = ga_checkpoint_size();
+    if (size > s_ckpt_buf_len) {
+        heap_caps_free(s_ckpt_buf);
+        s_ckpt_buf = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+        if (s_ckpt_buf == NULL) {
+            s_ckpt_buf = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+        }
+        s_ckpt_buf_len = (s_ckpt_buf != NULL) ? size : 0;
+    }
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    if (s_ckpt_buf != NULL && ga_checkpoint_encode(s_ckpt_buf, s_ckpt_buf_len) == size) {
+        err = ga_checkpoint_store(s_ckpt_buf, size);
+    }
+    if (err != ESP_OK) {
+        s_ckpt_stats.failures++;
+        return err;
+    }
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    s_ckpt_stats.saves++;
+    s_ckpt_stats.bytes = (uint32_t)size;
+    s_ckpt_stats.last_save_us = us;
+    if (us > s_ckpt_stats.max_save_us) {
+        s_ckpt_stats.max_save_us = us;
+    }
+    return ESP_OK;
+}
+
+void ga_get_checkpoint_stats(ga_checkpoint_stats_t *out) {
+    *out = s_ckpt_stats;
+}
+
+static void ga_complete_callback(void)
+{
+    ga_has_run_before = true;
+    s_last_ga_time = (uint32_t)(esp_timer_get_time() / 1000ULL);
+    // drain the buffered ESPNOW messages, a better remote solution
+    // is queued back to this worker as GA_CMD_INTEGRATE
+    drain_buffered_messages();
+}
 
+// Queue a G(enetic) event of the given log_type; its message body must
+// follow with the returned log id.
+static uint32_t queue_ga_event(const char *log_type, time_t now)
+{
+    event_log_t log_entry;
+
+    // Lock the mutex before accessing log_counter
+    if (xSemaphoreTake(logCounterMutex, portMAX_DELAY)) {
+        log_counter++;  // Increment the global log counter
+        xSemaphoreGive(logCounterMutex);   // Release the mutex after incrementing
+    }
+
+    log_entry.log_id = log_counter;
+    log_entry.log_datetime = now;
+    strcpy(log_entry.status, "T"); //T for internal task
+    strcpy(log_entry.tag, "G"); //G for genetic algo
+    strcpy(log_entry.log_level, "I"); //I for information
+    strcpy(log_entry.log_type, log_type);
+    strcpy(log_entry.from_id, "");
+    xQueueSend(LogQueue, &log_entry, portMAX_DELAY);
+    return log_entry.log_id;
+}
+
+// Log the current best individual as a G(enetic) event with its genes
+// in the message body. log_type is "S" for start, "U" for update.
+static void log_best_solution(const char *log_type, float best_fitness, time_t now)
+{
+    event_log_message_t log_body;
+
+    int offset = 0;  // track of where to write next in the buffer of msgbody
+    log_body.log_id = queue_ga_event(log_type, now);
+    log_body.log_datetime = now;
+    offset += sprintf(log_body.log_message + offset, "%.3f|", best_fitness);
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        offset += sprintf(log_body.log_message + offset, "%.3f|", geneValue(population[bestRow()][gene]));
+    }
+    xQueueSend(LogBodyQueue, &log_body, portMAX_DELAY);
+}
+
+#if GA_PROFILE
+// Log the phase cycles since the last record as a G/P event, body
+// "generation|phase:min/mean/max|...", and start a new window.
+static void log_phase_record(time_t now)
+{
+    event_log_message_t log_body;
+    int offset = 0;
+
+    log_body.log_id = queue_ga_event("P", now);
+    log_body.log_datetime = now;
+    offset += snprintf(log_body.log_message, sizeof(log_body.log_message), "%u|", (unsigned)s_generation);
+    for (int phase = 0; phase < GA_PHASE_COUNT; phase++) {
+        const ga_phase_stats_t *st = &s_phase_window[phase];
+        if (st->count == 0 || offset >= (int)sizeof(log_body.log_message)) {
+            continue;
+        }
+        offset += snprintf(log_body.log_message + offset, sizeof(log_body.log_message) - offset,
+                           "%s:%u/%u/%u|", s_phase_names[phase], (unsigned)st->min_cycles,
+                           (unsigned)(st->total_cycles / st->count), (unsigned)st->max_cycles);
+    }
+    xQueueSend(LogBodyQueue, &log_body, portMAX_DELAY);
+    memset(s_phase_window, 0, sizeof(s_phase_window));
+}
+#endif
+
+void ga_stagnation_reset(ga_stagnation_t *st, int patience)
+{
+    st->last_best = -1.0f;  // Init impossible fitness value
+    st->no_improvement = 0;
+    st->patience = patience;
+}
+
+bool ga_stagnation_update(ga_stagnation_t *st, float best)
+{
+    // Threshold for detecting significant changes in fitness
+    if (fabsf(best - st->last_best) > GA_STAGNATION_THRESHOLD) {
+        st->last_best = best;   //update last known best fitness
+        st->no_improvement = 0; //reset no improvement counter
+        return true;
+    }
+    st->no_improvement++;
+    return false;
+}
+
+bool ga_stagnated(const ga_stagnation_t *st)
+{
+    if (st->no_improvement >= st->patience) {
+        return true;
+    }
+    // A collapsed population would only idle through the rest of the
+    // patience window
+    return st->no_improvement >= GA_DIVERSITY_GRACE && ga_diversity_collapsed();
+}
+
+// Evolve until the population stagnates or a stop is requested.
+// Returns true if it ran to stagnation.
+static bool ga_run(void)
+{
+    ga_stagnation_t stagnation;
+    // Stop if there are consecutive no-gain generations TODO: get reference
+    ga_stagnation_reset(&stagnation, DEFAULT_PATIENCE);
+    static bool start_logged = false;
+    int64_t last_checkpoint_us = esp_timer_get_time();
+
+    while (1) {
+        time_t now = time(NULL);
+        
+        if (!start_logged) {
+            GA_PROFILE_CALL(GA_PHASE_LOGGING, log_best_solution("S", true_f[bestRow()], now)); // <--- S for start
             start_logged = true;
         }        
         
         evolve();  // Run GA
         taskYIELD();
-        if (ga_ended) {
-            ga_complete_callback();
-            break;
+        if (s_stop_requested) {
+            return false;
+        }
+#if GA_PROFILE
+        if (s_generation % GA_PROFILE_LOG_INTERVAL == 0) {
+            GA_PROFILE_CALL(GA_PHASE_LOGGING, log_phase_record(now));
+        }
+#endif
+
+        // Periodic checkpoint, so a brown-out loses at most one interval.
+        // Flash writes stall both cores' cache, hence not every generation.
+        if (g_ga_checkpoint && g_checkpoint_interval_ms > 0 &&
+            esp_timer_get_time() - last_checkpoint_us >= (int64_t)g_checkpoint_interval_ms * 1000) {
+            ga_checkpoint_save();
+            last_checkpoint_us = esp_timer_get_time();
         }
 
         // Prints the best true fitness of the population in this generation to 3 decimal places.
         // Rastrigin is a minimisation problem.
         // So we should see this descending towards 0
         // true_f[ ] = our store of original fitness values
-        // rank[ POP_SIZE -1 ] returns the index of the best population member
-        float current_best_fitness = true_f[rank[POP_SIZE - 1]]; 
+        // bestRow() returns the index of the best population member,
+        // the best of the island tops of rank[]
+        float current_best_fitness = true_f[bestRow()];
 
-        if (fabs(current_best_fitness - last_best_fitness) > threshold) {
+        if (ga_stagnation_update(&stagnation, current_best_fitness)) {
             ESP_LOGI(TAG, "Best true fitness: %.3f", current_best_fitness);
-            last_best_fitness = current_best_fitness;  //update last known best fitness
-            no_improvement_count = 0; //reset no improvement counter
             vTaskDelay(100);
-
-        } else {
-            no_improvement_count++;
         }
 
-        if (no_improvement_count >= patience) {
-            ESP_LOGI(TAG, "Stopping GA: No improvement for %d generations", patience);
-
-            event_log_t log_entry;
-            event_log_message_t log_body;
-
-            // Lock the mutex before accessing log_counter
-            if (xSemaphoreTake(logCounterMutex, portMAX_DELAY)) {
-                log_counter++;  // Increment the global log counter
-                xSemaphoreGive(logCounterMutex);   // Release the mutex after incrementing
-            }
-
-            log_entry.log_id = log_counter;
-            log_entry.log_datetime = now;
-            strcpy(log_entry.status, "T"); //T for internal task
-            strcpy(log_entry.tag, "G"); //G for genetic algo
-            strcpy(log_entry.log_level, "I"); //I for information
-            strcpy(log_entry.log_type, "U"); // U for update 
-            strcpy(log_entry.from_id, "");
-
-            // Send to queue
-            if (LogQueue == NULL) {
-                ESP_LOGW(TAG, "LogQueue is NULL! Exiting GA task.");
-                xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT);
-                vTaskDelete(NULL);
+        if (ga_stagnated(&stagnation)) {
+            if (stagnation.no_improvement >= stagnation.patience) {
+                ESP_LOGI(TAG, "Stopping GA: No improvement for %d generations", stagnation.patience);
+            } else {
+                ESP_LOGI(TAG, "Stopping GA: Diversity collapsed to %.4f after %d generations without improvement",
+                         ga_get_diversity(), stagnation.no_improvement);
             }
-            xQueueSend(LogQueue, &log_entry, portMAX_DELAY);
-
-            int offset = 0;  // track of where to write next in the buffer of msgbody
-            log_body.log_id = log_counter;
-            log_body.log_datetime = now;
-            offset += sprintf(log_body.log_message + offset, "%.3f|", current_best_fitness);
-            for (int gene = 0; gene < MAX_GENES; gene++) {
-                offset += sprintf(log_body.log_message + offset, "%.3f|", population[rank[POP_SIZE - 1]][gene]);
+            if (g_local_search != GA_LOCAL_SEARCH_OFF) {
+                ESP_LOGI(TAG, "Local search: %u evaluations, gain %.3f (best %.3f) in %llu us",
+                         (unsigned)s_ls_stats.evaluations, s_ls_stats.gain, s_ls_stats.best_gain,
+                         (unsigned long long)s_ls_stats.time_us);
             }
 
-            // Send to queue
-            if (LogBodyQueue == NULL) {
-                ESP_LOGW(TAG, "LogBodyQueue is NULL! Exiting GA task.");
-                xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT);
-                vTaskDelete(NULL);
+            GA_PROFILE_CALL(GA_PHASE_LOGGING, log_best_solution("U", current_best_fitness, now)); // U for update
+            if (g_ga_checkpoint) {
+                ga_checkpoint_save();
             }
-            xQueueSend(LogBodyQueue, &log_body, portMAX_DELAY);
-
 
             //send the best solution via ESP‑NOW
-            if (LogQueue == NULL || LogBodyQueue == NULL) {
-                ESP_LOGW(TAG, "LogQueue or LogBodyQueue is NULL! Exiting GA task.");
-                xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT);
-                vTaskDelete(NULL);
-            }
-
-            espnow_push_best_solution(
+            ga_island_t *best_island = bestIsland();
+            float migrant[MAX_GENES];
+            decodeRow(migrant, population[rank[islandTop(best_island) + 1 - DEFAULT_MIGRATION_RATE]]);
+            GA_PROFILE_CALL(GA_PHASE_MIGRATION_PUSH, espnow_push_best_solution(
                 current_best_fitness,
-                population[rank[POP_SIZE - DEFAULT_MIGRATION_RATE]],
+                migrant,
                 MAX_GENES,
                 log_counter,
                 now
-            );
-            
-            
-            ga_ended = true;
-            ga_complete_callback();
-            break;
+            ));
+
+            return true;
         }
+    }
+}
+
+static bool ga_send_command(ga_cmd_id_t id, const float *genes)
+{
+    if (s_ga_cmd_queue == NULL) {
+        ESP_LOGW(TAG, "GA worker not started, dropping command %d", id);
+        return false;
+    }
 
+    ga_cmd_t cmd = {
+        .id = id,
+        .enqueued_us = esp_timer_get_time(),
+    };
+    if (genes != NULL) {
+        memcpy(cmd.genes, genes, sizeof(cmd.genes));
     }
 
+    if (id == GA_CMD_STOP) {
+        // Let a run in progress see the stop at its next generation
+        s_stop_requested = true;
+    } else {
+        // A run is now pending, readers of GA_COMPLETED_BIT must not
+        // treat the GA as finished until the worker has been through it
+        xEventGroupClearBits(ga_event_group, GA_COMPLETED_BIT);
+    }
+
+    if (id == GA_CMD_STOP) {
+        // Never dropped: a stop ahead of the queued work is what the
+        // worker waits for once s_stop_requested is set
+        if (ga_task_handle == NULL) {
+            return false; // already stopped
+        }
+        xQueueSendToFront(s_ga_cmd_queue, &cmd, portMAX_DELAY);
+    } else if (xQueueSend(s_ga_cmd_queue, &cmd, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "GA command queue full, dropping command %d", id);
+        return false;
+    }
+    return true;
+}
+
+bool ga_request_run(void)
+{
+    return ga_send_command(GA_CMD_RUN, NULL);
+}
+
+bool ga_request_integrate(const float *remote_genes)
+{
+    return ga_send_command(GA_CMD_INTEGRATE, remote_genes);
+}
+
+bool ga_request_hyper_mutation(void)
+{
+    return ga_send_command(GA_CMD_HYPERMUTATE, NULL);
+}
+
+bool ga_request_stop(void)
+{
+    return ga_send_command(GA_CMD_STOP, NULL);
+}
+
+bool ga_is_idle(void)
+{
+    if (s_ga_cmd_queue == NULL || ga_event_group == NULL) {
+        return false;
+    }
+    return (xEventGroupGetBits(ga_event_group) & GA_COMPLETED_BIT) &&
+           uxQueueMessagesWaiting(s_ga_cmd_queue) == 0;
+}
+
+void ga_get_worker_stats(ga_worker_stats_t *out)
+{
+    *out = s_worker_stats;
+}
+
+esp_err_t ga_worker_start(void)
+{
+    if (s_ga_cmd_queue != NULL) {
+        return ESP_OK; // already running, the worker lives for the whole experiment
+    }
+
+    // Checked here rather than in ga_task, so a worker that could not log
+    // is never half started with a queue that nothing reads
+    if (LogQueue == NULL || LogBodyQueue == NULL) {
+        ESP_LOGE(TAG, "LogQueue or LogBodyQueue is NULL, not starting the GA worker");
+        return ESP_FAIL;
+    }
+
+    s_ga_cmd_queue = xQueueCreate(GA_CMD_QUEUE_LEN, sizeof(ga_cmd_t));
+    if (s_ga_cmd_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create GA command queue");
+        return ESP_FAIL;
+    }
+
+    // The helper is cheap to keep parked, start it now so switching
+    // g_parallel_evolve on later needs no task creation on the GA path.
+    if (ga_parallel_start() != ESP_OK) {
+        ESP_LOGW(TAG, "No GA helper task, parallel evolve will run on one core");
+    }
+
+    s_stop_requested = false;
+    xEventGroupClearBits(ga_event_group, GA_RUNNING_BIT | GA_STOPPED_BIT);
     xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT);
+
+    if (xTaskCreatePinnedToCore(ga_task, "GA Task", 8192, NULL, 3, &ga_task_handle, 1) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create GA worker task");
+        vQueueDelete(s_ga_cmd_queue);
+        s_ga_cmd_queue = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static void ga_worker_exit(void)
+{
+    xEventGroupClearBits(ga_event_group, GA_RUNNING_BIT);
+    xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT | GA_STOPPED_BIT);
+    ga_task_handle = NULL;
     vTaskDelete(NULL);
 }
+
+// Long-lived GA worker, started once by ga_worker_start(). All population
+// changes (runs, migrant integration, hyper-mutation) happen on this task,
+// in the order the commands were queued.
+void ga_task(void *pvParameters) {
+    (void)pvParameters;
+
+    ga_cmd_t cmd;
+    while (1) {
+        if (xQueueReceive(s_ga_cmd_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        if (cmd.id == GA_CMD_STOP) {
+            ESP_LOGI(TAG, "Stopping GA worker");
+            ga_worker_exit();
+        }
+        if (s_stop_requested) {
+            continue; // discard work queued ahead of the stop
+        }
+
+        // Restart latency: command queued -> first generation
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - cmd.enqueued_us);
+        s_worker_stats.runs++;
+        s_worker_stats.last_restart_us = latency_us;
+        s_worker_stats.total_restart_us += latency_us;
+        if (latency_us > s_worker_stats.max_restart_us) {
+            s_worker_stats.max_restart_us = latency_us;
+        }
+
+        xEventGroupSetBits(ga_event_group, GA_RUNNING_BIT);
+
+        switch (cmd.id) {
+            case GA_CMD_INTEGRATE:
+                ga_integrate_remote_solution(cmd.genes);
+                break;
+            case GA_CMD_HYPERMUTATE:
+                activate_hyper_mutation();
+                break;
+            default:
+                break;
+        }
+
+        bool stagnated = ga_run();
+
+        xEventGroupClearBits(ga_event_group, GA_RUNNING_BIT);
+        if (uxQueueMessagesWaiting(s_ga_cmd_queue) == 0) {
+            xEventGroupSetBits(ga_event_group, GA_COMPLETED_BIT);
+            // ga_send_command() clears the bit before it queues, so a
+            // command that came in between our check and the set is seen
+            // here and the bit goes back, as ga_is_idle() would have it
+            if (uxQueueMessagesWaiting(s_ga_cmd_queue) != 0) {
+                xEventGroupClearBits(ga_event_group, GA_COMPLETED_BIT);
+            }
+        }
+        if (stagnated) {
+            ga_complete_callback();
+        }
+    }
+}
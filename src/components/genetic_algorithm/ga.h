@@ -7,13 +7,17 @@ extern "C" {
 
 #include <stdint.h> 
 #include <stdbool.h>
+#include <stddef.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "esp_err.h"
+#include "globals.h"
 
 // Constants
 
-#define MAX_GENE_VALUE  5.12    // To use the Rastrigin Function as a problem, 
-#define MIN_GENE_VALUE  -5.12   // we use values [-5.12 : +5.12]
+// The problem is picked from the benchmark functions in ga_fitness.h by
+// g_fitness_function. Each comes with its own gene bounds, e.g. the
+// Rastrigin function uses values [-5.12 : +5.12].
 
 // Mutation can be thought of as the "fine grained" search.
 // A candidate solution is located in the search-space somewhere,
@@ -23,15 +27,49 @@ extern "C" {
 // more often.
 //MUTATE PROB commented out because it becomes a runtime variable
 //#define MUTATE_PROB     0.6     // range [0:1], how often do we apply mutation?
-#define MUTATE_WIDTH    0.05    // gaussian standard dev
+//PERCENT_CHILD, XOVER_PROB and MUTATE_WIDTH can be overridden at compile
+//time, the host convergence suite (src/host) builds one GA per setting.
+#ifndef MUTATE_WIDTH
+#define MUTATE_WIDTH    0.05    // gaussian standard dev for Rastrigin's 10.24 gene
+                                // range, scaled to the selected function's range
+#endif
+#define MUTATE_WIDTH_RANGE 10.24 // gene range MUTATE_WIDTH is given for
 #define MUTATE_MEAN     0.0     // gaussian center
 
+// With g_adaptive_mutation the standard dev above is only the starting
+// point. Each island adapts its own by the 1/5th success rule once per
+// generation: a child is a success if it beats its first parent, and
+// sigma grows when more than GA_SIGMA_TARGET_SUCCESS of the children
+// succeed and shrinks when fewer do, by at most exp(GA_SIGMA_ADAPT_RATE)
+// per generation. Sigma stays within [GA_SIGMA_MIN, GA_SIGMA_MAX] times
+// the gene range.
+#ifndef GA_ADAPTIVE_MUTATION
+#define GA_ADAPTIVE_MUTATION    1
+#endif
+#define GA_SIGMA_TARGET_SUCCESS 0.2f
+#define GA_SIGMA_ADAPT_RATE     0.3f
+#define GA_SIGMA_MIN            1.0e-6f
+#define GA_SIGMA_MAX            0.25f
+
+// Hyper-mutation is graded when g_adaptive_mutation is set. Each request
+// that finds the best no better than at the previous request raises the
+// level, up to GA_HYPER_MAX_LEVEL; one that finds it improved starts
+// again at level 1. Level L multiplies sigma by GA_HYPER_SIGMA_BOOST^L and
+// moves the mutation probability L/GA_HYPER_MAX_LEVEL of the way to 1,
+// both fading back linearly over s_hyper_mutation_generations. Without
+// g_adaptive_mutation it is the old switch: probability 1 for the
+// remaining hyper-mutation generations.
+#define GA_HYPER_MAX_LEVEL      4
+#define GA_HYPER_SIGMA_BOOST    2.0f
+
 // Cross-over takes two candidate solutions, chops them in half,
 // and glues them back together.  This represents a coarse search,
 // or large jumps in the search space.  This is very disruptive, but
 // has theoretical advantage to get out of local maxima/minima.
 // Therefore, applied less frequently than mutation.
+#ifndef XOVER_PROB
 #define XOVER_PROB      0.1     // range [0:1]
+#endif
 
 
 // This GA is using a steady-state evoluation. This means that for
@@ -39,9 +77,27 @@ extern "C" {
 // without modification.  This GA also adopts an "elistist" approach,
 // carrying over only the best candidates.  Below is the percentage
 // of new children, therefore the elite carry-over is 1 - PERCENT_CHILD
+#ifndef PERCENT_CHILD
 #define PERCENT_CHILD   0.7     // range [0:1] 
                                 // e.g. 1 = total replacement
                                 //      0 = no children (no evolution)
+#endif
+
+// A run stops once the best fitness has moved by no more than
+// GA_STAGNATION_THRESHOLD for DEFAULT_PATIENCE generations in a row.
+#define GA_STAGNATION_THRESHOLD 0.01f
+
+// Population diversity is the RMS over genes of the per-gene standard
+// deviation around the centroid, divided by the gene range: about 0.29
+// for a uniform random population, 0 once every row is the same. The
+// per-gene mean and squared deviations are updated as rows are replaced
+// and recomputed in full every GA_DIVERSITY_REFRESH generations to drop
+// rounding drift. With g_diversity_collapse set, a run that has not
+// improved for GA_DIVERSITY_GRACE generations stops as soon as the
+// diversity is below it, rather than waiting out the patience window,
+// and the worker may be sent straight to hyper-mutation.
+#define GA_DIVERSITY_REFRESH    64
+#define GA_DIVERSITY_GRACE      5
 
 // A is a part of the rastrigin function
 // which we are using here as a fitness function
@@ -49,26 +105,294 @@ extern "C" {
 // https://en.wikipedia.org/wiki/Rastrigin_function
 #define A 10.0
 
+// Quantised genes. With GA_QUANTISED_GENES the population stores each
+// gene as an int16_t step of (max - min) / (2 * GA_GENE_QMAX) either side
+// of the centre of the gene range: 1.6e-4 for Rastrigin, finer than the
+// three decimals migration always sent. That halves the rows, the bulk of
+// the GA arena, and lets migration send a genome as hex codes rather
+// than decimals. Rows are decoded to floats for the fitness kernels and
+// the operators and rounded back as they are written, so every fitness
+// stored is that of the genes actually kept. Without it ga_gene_t is
+// float and rows are used as they are. The switch is in globals.h, as
+// it also sizes the migration frame.
+#define GA_GENE_QMAX 32767
+
+#if GA_QUANTISED_GENES
+typedef int16_t ga_gene_t;
+#else
+typedef float ga_gene_t;
+#endif
+
+// Generations of best fitness kept by ga_get_best_history() (in PSRAM)
+#define GA_HISTORY_LEN 256
+
+// Islands. init_ga() splits the population into g_num_islands
+// sub-populations that select and breed only among themselves. Every
+// g_island_migration_interval generations each island's best
+// GA_ISLAND_MIGRANTS replace the worst of the next island in a ring.
+// With g_parallel_evolve the islands are shared between both cores.
+#define GA_MAX_ISLANDS      8
+#define GA_MIN_ISLAND_SIZE  4   // must stay above 2 * GA_ISLAND_MIGRANTS
+#define GA_ISLAND_MIGRANTS  1
+
+// Optimiser engines. g_ga_engine picks the one init_ga() sets up; all of
+// them breed into the same population, islands, ranking and worker, so
+// migration, stagnation and logging work unchanged. GA_DEFAULT_ENGINE can
+// be overridden at compile time for the host convergence suite.
+typedef enum {
+    GA_ENGINE_GA,       // steady-state roulette GA, the tunables above
+    GA_ENGINE_DE,       // differential evolution, DE/rand/1/bin
+    GA_ENGINE_SEP_CMA,  // separable (diagonal) CMA-ES, one distribution per island
+    GA_ENGINE_COUNT,
+} ga_engine_id_t;
+
+#ifndef GA_DEFAULT_ENGINE
+#define GA_DEFAULT_ENGINE GA_ENGINE_GA
+#endif
+
+// Differential evolution. Every row is a target each generation: its
+// trial is a + GA_DE_F * (b - c) from three other rows of the island,
+// taking each gene with probability GA_DE_CR (and one gene always), and
+// replaces the target only if it is no worse.
+#define GA_DE_F     0.5f
+#define GA_DE_CR    0.9f
+
+// sep-CMA-ES (Ros & Hansen 2008). Each generation the island's best mu =
+// size / 2 rows, log-weighted, move the mean and adapt the diagonal
+// covariance and step size; the other size - 1 rows are then resampled
+// and the best is kept, so the published best never gets worse. The step
+// size starts at GA_CMA_SIGMA0 of the gene range and stays within
+// [GA_SIGMA_MIN, GA_CMA_SIGMA_MAX] of it. Hyper-mutation multiplies it by
+// GA_HYPER_SIGMA_BOOST^level instead of a mass extinction.
+#define GA_CMA_SIGMA0       0.3f
+#define GA_CMA_SIGMA_MAX    1.0f
+
+// Memetic local search. When g_local_search allows it, evolve() spends up
+// to g_local_search_budget fitness evaluations per generation on a (1+1)-ES
+// around the best GA_LOCAL_SEARCH_TOP_K rows of each island, after ranking
+// and before breeding. A candidate perturbs every gene by the search's own
+// step size and replaces the row only if it is better; the step grows by
+// exp(1/3) on a success and shrinks by exp(-1/12) on a failure (1/5th
+// rule), within [GA_SIGMA_MIN, GA_SIGMA_MAX] of the gene range.
+// GA_LOCAL_SEARCH_ON_STALL only searches once the best has not moved by
+// GA_STAGNATION_THRESHOLD for GA_LOCAL_SEARCH_STALL generations, i.e.
+// inside the patience window rather than instead of evolving.
+typedef enum {
+    GA_LOCAL_SEARCH_OFF,
+    GA_LOCAL_SEARCH_EVERY_GENERATION,
+    GA_LOCAL_SEARCH_ON_STALL,
+} ga_local_search_mode_t;
+
+#ifndef GA_LOCAL_SEARCH
+#define GA_LOCAL_SEARCH         GA_LOCAL_SEARCH_OFF
+#endif
+#define GA_LOCAL_SEARCH_TOP_K   3
+#define GA_LOCAL_SEARCH_EVALS   12
+#define GA_LOCAL_SEARCH_STALL   (DEFAULT_PATIENCE / 4)
+
+// Per-phase profiling. With GA_PROFILE set, the GA task times each phase
+// of a generation with esp_cpu_get_cycle_count() and keeps min/mean/max
+// per phase (ga_get_phase_stats()). Every GA_PROFILE_LOG_INTERVAL
+// generations ga_task logs them as one G/P event, covering the
+// generations since the previous record. Without it none of this is
+// compiled. Only the GA task's own cycles are counted: with
+// g_parallel_evolve the helper's half of the breeding overlaps them.
+#ifndef GA_PROFILE
+#define GA_PROFILE 0
+#endif
+#define GA_PROFILE_LOG_INTERVAL 100
+
+typedef enum {
+    GA_PHASE_FITNESS,       // determineFitness() and the children's evaluation
+    GA_PHASE_RANKING,       // updateRanking()
+    GA_PHASE_SELECTION,     // selection tables (or the engine's update) per island
+    GA_PHASE_BREED,         // crossover and mutation, without the two above
+    GA_PHASE_COPY_BACK,     // elites to the back buffer, swap, children's fitness
+    GA_PHASE_LOGGING,       // G events to the SD log queues
+    GA_PHASE_MIGRATION_PUSH,// espnow_push_best_solution()
+    GA_PHASE_COUNT,
+} ga_phase_t;
+
+// Cycles of one phase: per generation for the evolve() phases, per call
+// for logging and the migration push.
+typedef struct {
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;      // divide by count for the mean
+} ga_phase_stats_t;
+
+// Checkpoints. A checkpoint is the whole GA context as one blob: the
+// rows, their fitness and ranking, every island's generator and mutation
+// state, the sep-CMA-ES and local search state and the generation count.
+// Restoring it carries the run on exactly as if it had never stopped.
+// With g_ga_checkpoint, ga_run() stores one through ga_checkpoint_store()
+// (ga_checkpoint.h) at the end of every run and every
+// g_checkpoint_interval_ms while evolving; with g_ga_resume, init_ga()
+// restores the newest one instead of seeding a new population. The blob
+// layout is only readable by the same firmware, GA_CHECKPOINT_VERSION,
+// MAX_GENES and GA_QUANTISED_GENES must match.
+#ifndef GA_CHECKPOINT
+#define GA_CHECKPOINT               1
+#endif
+#define GA_CHECKPOINT_INTERVAL_MS   30000
+#define GA_CHECKPOINT_VERSION       2
+
+typedef struct {
+    uint32_t saves;
+    uint32_t failures;          // encode or store errors, the last good checkpoint stays
+    uint32_t bytes;             // size of the last checkpoint
+    uint32_t last_save_us;      // encode + store, latest
+    uint32_t max_save_us;
+    uint32_t resumed_generation;// generation init_ga() resumed from, 0 = cold start
+} ga_checkpoint_stats_t;
+
+// Parent selection. All modes are fitness proportionate.
+typedef enum {
+    GA_SELECTION_ROULETTE,  // Prefix sums + binary search, O(log n) per draw
+    GA_SELECTION_ALIAS,     // Vose alias table, O(1) per draw
+    GA_SELECTION_SUS,       // Stochastic universal sampling, all first parents in one pass
+} ga_selection_mode_t;
+
 // Global variables
 extern float g_mutate_prob;
-extern volatile bool ga_ended;
+extern ga_selection_mode_t g_selection_mode;
+extern int g_fitness_function;      // ga_fitness_id_t the next init_ga() optimises
+extern bool g_adaptive_mutation;    // 1/5th rule sigma and graded hyper-mutation
+extern int g_ga_engine;             // ga_engine_id_t the next init_ga() runs
+extern ga_local_search_mode_t g_local_search; // read every generation
+extern int g_local_search_budget;   // evaluations per generation, all islands
+extern bool g_parallel_evolve;      // breed on both cores, see ga_parallel.h
+extern bool g_ga_checkpoint;        // store checkpoints from ga_run()
+extern uint32_t g_checkpoint_interval_ms; // while evolving, 0 = only at the end of a run
 extern TaskHandle_t ga_task_handle;
 extern const uint8_t qrng_anu_ca_crt_start[] asm("_binary_qrng_anu_ca_pem_start");
 extern const uint8_t qrng_anu_ca_crt_end[] asm("_binary_qrng_anu_ca_pem_end");
-#define GA_COMPLETED_BIT BIT0
+// ga_event_group status bits, owned by the GA worker
+#define GA_COMPLETED_BIT BIT0   // no run in progress and none queued
+#define GA_RUNNING_BIT   BIT1   // worker is evolving
+#define GA_STOPPED_BIT   BIT2   // worker has exited after GA_CMD_STOP
 extern EventGroupHandle_t ga_event_group;
 extern bool ga_has_run_before;
 extern uint32_t s_last_ga_time;
 
+// Commands accepted by the persistent GA worker (ga_task)
+typedef enum {
+    GA_CMD_RUN,         // evolve until stagnation
+    GA_CMD_INTEGRATE,   // overwrite the worst individuals with remote genes, then run
+    GA_CMD_HYPERMUTATE, // mass extinction + hyper-mutation, then run
+    GA_CMD_STOP,        // abort any run and end the worker
+} ga_cmd_id_t;
+
+// Stagnation rule of a GA run, see ga_stagnation_update().
+typedef struct {
+    float last_best;            // best fitness when it last moved
+    int no_improvement;         // generations since then
+    int patience;
+} ga_stagnation_t;
+
+typedef struct {
+    uint32_t runs;              // commands that started a run
+    uint32_t last_restart_us;   // command queued -> run started, latest
+    uint32_t max_restart_us;
+    uint64_t total_restart_us;  // divide by runs for the mean
+} ga_worker_stats_t;
+
+// Fitness evaluation counters since init_ga(). Only rows whose genes
+// changed (children, migrants, mass extinction) are re-evaluated.
+typedef struct {
+    uint32_t evaluated;
+    uint32_t skipped;
+} ga_fitness_stats_t;
+
+// Mutation state, see GA_ADAPTIVE_MUTATION.
+typedef struct {
+    float sigma;                // island 0's standard dev, before any boost
+    float success_rate;         // island 0's children that beat their parent, last generation
+    float sigma_boost;          // current hyper-mutation multiplier, 1 when none
+    int hyper_level;            // 0 = no hyper-mutation so far
+    uint32_t sigma_updates;     // 1/5th rule steps since init_ga()
+} ga_mutation_stats_t;
+
+// Local search cost and gain since init_ga(), see GA_LOCAL_SEARCH.
+// Its evaluations are also counted in ga_fitness_stats_t.
+typedef struct {
+    uint32_t generations;       // generations that searched
+    uint32_t evaluations;
+    uint32_t improvements;      // candidates that replaced their row
+    float gain;                 // sum of fitness decreases of the rows searched
+    float best_gain;            // of those, decreases of the overall best
+    uint64_t time_us;           // esp_timer time spent searching
+    float step;                 // current (1+1)-ES step size
+} ga_local_search_stats_t;
+
+// Best individual, published by the GA once per generation. Any task
+// may take a copy with ga_get_best_snapshot() without locking.
+typedef struct {
+    float fitness;              // fitness function value, lower is better
+    float genes[MAX_GENES];
+    uint32_t generation;        // evolve() calls since init_ga()
+    int64_t timestamp_us;       // esp_timer time of publication
+    float diversity;            // of the whole population, see GA_DIVERSITY_REFRESH
+} ga_best_snapshot_t;
+
 // Interface functions
-void init_ga(bool wifiAvailable);
+esp_err_t init_ga(bool wifiAvailable);  // sizes the GA for g_pop_size, then seeds it for g_fitness_function and g_ga_engine,
+                                        // or with g_ga_resume restores the last checkpoint if there is one
+const char *ga_engine_name(int engine); // NULL if no such engine
+float ga_evaluate(const float *genes);  // value of the current fitness function, lower is better
+int16_t ga_gene_quantise(float gene);   // nearest GA_QUANTISED_GENES code for the current gene range
+float ga_gene_dequantise(int16_t code); // exact inverse on codes, whether or not the population is quantised
+int ga_population_size(void);           // size of the current population
+int ga_island_count(void);              // islands of the current population
+float ga_get_island_best_fitness(int island); // GA task or idle GA only, -1 if no such island
+uint32_t ga_get_ring_migrations(void);  // ring migrations since init_ga()
+int ga_get_best_history(float *out, int max_count); // newest best fitnesses, oldest first
+esp_err_t ga_worker_start(void);    // ga_event_group and the log queues must exist
+bool ga_request_run(void);
+bool ga_request_integrate(const float *remote_genes);
+bool ga_request_hyper_mutation(void);
+bool ga_request_stop(void);
+bool ga_is_idle(void);
+void ga_get_worker_stats(ga_worker_stats_t *out);
+void ga_get_fitness_stats(ga_fitness_stats_t *out);
+void ga_get_mutation_stats(ga_mutation_stats_t *out);
+void ga_get_local_search_stats(ga_local_search_stats_t *out);
+void ga_get_checkpoint_stats(ga_checkpoint_stats_t *out);
+size_t ga_checkpoint_size(void);                 // bytes ga_checkpoint_encode() needs now
+size_t ga_checkpoint_encode(void *buf, size_t len); // GA task or idle GA only, 0 if len is too small
+esp_err_t ga_checkpoint_restore(const void *buf, size_t len); // replaces the GA, worker not running
+esp_err_t ga_checkpoint_save(void);              // encode and ga_checkpoint_store(), GA task or idle GA only
+#if GA_PROFILE
+void ga_get_phase_stats(ga_phase_stats_t *out);    // GA_PHASE_COUNT entries, since init_ga()
+const char *ga_phase_name(int phase);
+#endif
 void print_population(void);
 void print_ranking(void);
-float ga_get_local_best_fitness(void);
-void ga_integrate_remote_solution(const float *remote_genes);
-void ga_task(void *pvParameters);  // Expose the task function for external use
+bool ga_get_best_snapshot(ga_best_snapshot_t *out); // false until init_ga() has run
+float ga_get_local_best_fitness(void);              // snapshot fitness, -1 before init_ga()
+float ga_get_diversity(void);                       // snapshot diversity, -1 before init_ga()
+bool ga_diversity_collapsed(void);                  // below g_diversity_collapse, if set
+void ga_integrate_remote_solution(const float *remote_genes); // GA task only, use ga_request_integrate()
+void ga_task(void *pvParameters);  // Worker body, started by ga_worker_start()
+void ga_stagnation_reset(ga_stagnation_t *st, int patience);
+bool ga_stagnation_update(ga_stagnation_t *st, float best); // true if best moved
+bool ga_stagnated(const ga_stagnation_t *st);
 void activate_hyper_mutation(void);
 
+// GA stages, exposed so the host benchmark (src/host) can time them.
+// Ranking and selection tables are per island; the two selection draws
+// pick from island 0.
+void determineFitness(void);         // dirty rows only
+void ga_invalidate_fitness(void);   // mark every row for re-evaluation
+void createRanking(void);
+void updateRanking(void);
+void prepareSelection(void);
+int rouletteSelection(void);
+void susSelection(int *parents, int count);
+float ga_measure_diversity(void);    // full O(pop * genes) pass, to check the incremental one
+void evolve(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,144 @@
+#include "ga_checkpoint.h"
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_crc.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "GA_CKPT";
+
+#define GA_CKPT_MAGIC   0x54504b43u // "CKPT"
+#define GA_CKPT_SLOTS   2
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;       // higher is newer
+    uint32_t len;       // blob bytes after the header
+    uint32_t crc;       // esp_crc32_le() of the blob
+} ga_ckpt_header_t;
+
+static const esp_partition_t *s_partition = NULL;
+
+static const esp_partition_t *findPartition(void)
+{
+    if (s_partition == NULL) {
+        s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                               GA_CHECKPOINT_PARTITION);
+        if (s_partition == NULL) {
+            ESP_LOGW(TAG, "No %s partition, checkpoints disabled", GA_CHECKPOINT_PARTITION);
+        }
+    }
+    return s_partition;
+}
+
+static inline size_t slotSize(const esp_partition_t *part)
+{
+    return (part->size / GA_CKPT_SLOTS) & ~(size_t)(part->erase_size - 1);
+}
+
+// Header of a slot, false if it was never written or is not plausible.
+static bool readHeader(const esp_partition_t *part, int slot, ga_ckpt_header_t *hdr)
+{
+    if (esp_partition_read(part, slot * slotSize(part), hdr, sizeof(*hdr)) != ESP_OK) {
+        return false;
+    }
+    return hdr->magic == GA_CKPT_MAGIC && hdr->len > 0 && hdr->len <= slotSize(part) - sizeof(*hdr);
+}
+
+esp_err_t ga_checkpoint_store(const void *data, size_t len)
+{
+    const esp_partition_t *part = findPartition();
+    if (part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    size_t slot_size = slotSize(part);
+    if (len == 0 || len > slot_size - sizeof(ga_ckpt_header_t)) {
+        ESP_LOGE(TAG, "Checkpoint of %u bytes does not fit a %u byte slot", (unsigned)len, (unsigned)slot_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    // Overwrite the older slot, never the one holding the newest
+    ga_ckpt_header_t hdr[GA_CKPT_SLOTS];
+    int slot = 0;
+    uint32_t seq = 0;
+    for (int s = 0; s < GA_CKPT_SLOTS; s++) {
+        if (readHeader(part, s, &hdr[s]) && hdr[s].seq >= seq) {
+            seq = hdr[s].seq;
+            slot = (s + 1) % GA_CKPT_SLOTS;
+        }
+    }
+
+    ga_ckpt_header_t out = {
+        .magic = GA_CKPT_MAGIC,
+        .seq = seq + 1,
+        .len = (uint32_t)len,
+        .crc = esp_crc32_le(0, data, len),
+    };
+    size_t offset = slot * slot_size;
+    size_t erase = (sizeof(out) + len + part->erase_size - 1) & ~(size_t)(part->erase_size - 1);
+    esp_err_t err = esp_partition_erase_range(part, offset, erase);
+    // Blob first, header last: a slot only becomes valid once complete
+    if (err == ESP_OK) {
+        err = esp_partition_write(part, offset + sizeof(out), data, len);
+    }
+    if (err == ESP_OK) {
+        err = esp_partition_write(part, offset, &out, sizeof(out));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write checkpoint slot %d: %s", slot, esp_err_to_name(err));
+    }
+    return err;
+}
+
+esp_err_t ga_checkpoint_load(void **data, size_t *len)
+{
+    const esp_partition_t *part = findPartition();
+    if (part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ga_ckpt_header_t hdr[GA_CKPT_SLOTS];
+    bool valid[GA_CKPT_SLOTS];
+    for (int s = 0; s < GA_CKPT_SLOTS; s++) {
+        valid[s] = readHeader(part, s, &hdr[s]);
+    }
+
+    // Newest first, the other slot if its blob turns out torn
+    int first = (valid[1] && (!valid[0] || hdr[1].seq > hdr[0].seq)) ? 1 : 0;
+    for (int i = 0; i < GA_CKPT_SLOTS; i++) {
+        int slot = (first + i) % GA_CKPT_SLOTS;
+        if (!valid[slot]) {
+            continue;
+        }
+        void *blob = heap_caps_malloc(hdr[slot].len, MALLOC_CAP_SPIRAM);
+        if (blob == NULL) {
+            blob = heap_caps_malloc(hdr[slot].len, MALLOC_CAP_DEFAULT);
+        }
+        if (blob == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        if (esp_partition_read(part, slot * slotSize(part) + sizeof(hdr[slot]), blob, hdr[slot].len) == ESP_OK &&
+            esp_crc32_le(0, blob, hdr[slot].len) == hdr[slot].crc) {
+            *data = blob;
+            *len = hdr[slot].len;
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "Checkpoint slot %d (seq %u) is corrupt", slot, (unsigned)hdr[slot].seq);
+        heap_caps_free(blob);
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ga_checkpoint_erase(void)
+{
+    const esp_partition_t *part = findPartition();
+    if (part == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    // The header sectors are enough to invalidate both slots
+    esp_err_t err = ESP_OK;
+    for (int s = 0; s < GA_CKPT_SLOTS && err == ESP_OK; s++) {
+        err = esp_partition_erase_range(part, s * slotSize(part), part->erase_size);
+    }
+    return err;
+}
@@ -0,0 +1,31 @@
+#ifndef GA_CHECKPOINT_H
+#define GA_CHECKPOINT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "esp_err.h"
+
+// Flash store for the blobs of ga_checkpoint_encode() (ga.h).
+//
+// The GA_CHECKPOINT_PARTITION data partition (partitions.csv) is split in
+// two slots and saves alternate between them, so a brown-out in the middle
+// of a save still leaves the previous checkpoint to resume from. Each slot
+// starts with a header carrying a sequence number, which picks the newest,
+// and a CRC of the blob, which rejects a torn write. Only the sectors the
+// blob needs are erased, a save of a 60 individual GA erases one.
+#define GA_CHECKPOINT_PARTITION "ga_ckpt"
+
+esp_err_t ga_checkpoint_store(const void *data, size_t len);
+// Newest intact checkpoint, ESP_ERR_NOT_FOUND if there is none. The caller
+// frees *data with heap_caps_free().
+esp_err_t ga_checkpoint_load(void **data, size_t *len);
+esp_err_t ga_checkpoint_erase(void);    // forget both slots
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GA_CHECKPOINT_H
@@ -0,0 +1,21 @@
+#include "ga_fitness.h"
+
+// The kernels are inline in ga_fitness.h and unrolled for MAX_GENES; this
+// table instantiates each one once and gives it its search domain. Bounds
+// are the customary ones for each benchmark.
+static const ga_fitness_function_t s_fitness_functions[GA_FITNESS_COUNT] = {
+    [GA_FITNESS_RASTRIGIN]  = { "RASTRIGIN",  -5.12f,   5.12f,   ga_rastrigin },
+    [GA_FITNESS_SPHERE]     = { "SPHERE",     -5.12f,   5.12f,   ga_sphere },
+    [GA_FITNESS_ROSENBROCK] = { "ROSENBROCK", -2.048f,  2.048f,  ga_rosenbrock },
+    [GA_FITNESS_ACKLEY]     = { "ACKLEY",     -32.768f, 32.768f, ga_ackley },
+    [GA_FITNESS_SCHWEFEL]   = { "SCHWEFEL",   -500.0f,  500.0f,  ga_schwefel },
+    [GA_FITNESS_GRIEWANK]   = { "GRIEWANK",   -600.0f,  600.0f,  ga_griewank },
+};
+
+const ga_fitness_function_t *ga_fitness_lookup(int id)
+{
+    if (id < 0 || id >= GA_FITNESS_COUNT) {
+        return NULL;
+    }
+    return &s_fitness_functions[id];
+}
@@ -0,0 +1,182 @@
+#ifndef GA_FITNESS_H
+#define GA_FITNESS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <math.h>
+#include "globals.h"
+#include "ga.h"
+
+// Single precision fitness kernels.
+//
+// The ESP32 FPU only does single precision, so the double pow()/cos()
+// the GA used to call per gene ran in soft-float emulation. Everything
+// here stays in float; only Ackley needs libm (expf/sqrtf).
+//
+// Every kernel maps one genome to a value >= 0 (up to rounding) with the
+// optimum at 0, which the GA minimises. MAX_GENES is a compile-time
+// constant, so each gene loop is fully unrolled for the configured genome
+// and ga.c only dispatches once per genome, through the registry below.
+
+#define GA_TWO_PI_F      6.28318530717958647692f
+#define GA_RASTRIGIN_A_F ((float)A)
+
+// Max absolute error of ga_cos2pi() against double precision libm
+// cos(2*pi*x) for |x| <= 5.12 (the Rastrigin bounds). The series
+// truncation error is below 6e-8, the rest is float rounding.
+// ga_fitness_bench checks this.
+#define GA_COS2PI_MAX_ABS_ERROR 3.0e-7f
+
+// Max error of every kernel against a double precision evaluation at
+// random genomes within its bounds, relative to 1 + |f|. Dominated by
+// float rounding of the sums. ga_fitness_bench checks this.
+#define GA_KERNEL_MAX_REL_ERROR 1.0e-5f
+
+// Benchmark functions. The id is what g_fitness_function selects.
+typedef enum {
+    GA_FITNESS_RASTRIGIN,
+    GA_FITNESS_SPHERE,
+    GA_FITNESS_ROSENBROCK,
+    GA_FITNESS_ACKLEY,
+    GA_FITNESS_SCHWEFEL,
+    GA_FITNESS_GRIEWANK,
+    GA_FITNESS_COUNT,
+} ga_fitness_id_t;
+
+typedef float (*ga_fitness_kernel_t)(const float *genes);
+
+typedef struct {
+    const char *name;
+    float min_gene;             // search domain, the same for every gene
+    float max_gene;
+    ga_fitness_kernel_t kernel; // specialised for MAX_GENES
+} ga_fitness_function_t;
+
+// Registry entry for id, NULL if there is none (ga_fitness.c).
+const ga_fitness_function_t *ga_fitness_lookup(int id);
+
+// cos(2*pi*x) with x in turns rather than radians, branch free.
+// Range reduction: cos is even and 1-periodic, so t = |x| - nearest
+// integer, taken absolute, lies in [0, 0.5]. There
+// cos(2*pi*t) = sin(w) with w = 2*pi*(0.25 - t) in [-pi/2, pi/2],
+// where a degree 11 odd Taylor polynomial, evaluated with Horner in w^2,
+// is enough for float.
+static inline float ga_cos2pi(float x)
+{
+    float ax = fabsf(x);
+    float t = fabsf(ax - (float)(int)(ax + 0.5f));
+
+    float w = GA_TWO_PI_F * (0.25f - t);
+    float z = w * w;
+    return w * (1.0f + z * (-1.0f / 6.0f
+                     + z * ( 1.0f / 120.0f
+                     + z * (-1.0f / 5040.0f
+                     + z * ( 1.0f / 362880.0f
+                     + z * (-1.0f / 39916800.0f))))));
+}
+
+// Rastrigin over one genome, f = A*n + sum(x^2 - A*cos(2*pi*x)).
+// MAX_GENES is a compile-time constant so the gene loop is fully unrolled.
+static inline float ga_rastrigin(const float *genes)
+{
+    float f_sum = 0.0f;
+
+#pragma GCC unroll 32
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float x = genes[gene];
+        f_sum += x * x - GA_RASTRIGIN_A_F * ga_cos2pi(x);
+    }
+
+    return GA_RASTRIGIN_A_F * MAX_GENES + f_sum;
+}
+
+// Sphere (De Jong F1), f = sum(x^2). Unimodal, a sanity baseline.
+static inline float ga_sphere(const float *genes)
+{
+    float f_sum = 0.0f;
+
+#pragma GCC unroll 32
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        f_sum += genes[gene] * genes[gene];
+    }
+
+    return f_sum;
+}
+
+// Rosenbrock, f = sum(100*(x[i+1] - x[i]^2)^2 + (1 - x[i])^2) over
+// consecutive gene pairs. Optimum at x = (1, ..., 1) in a narrow valley.
+static inline float ga_rosenbrock(const float *genes)
+{
+    float f_sum = 0.0f;
+
+#pragma GCC unroll 32
+    for (int gene = 0; gene < MAX_GENES - 1; gene++) {
+        float x = genes[gene];
+        float valley = genes[gene + 1] - x * x;
+        float slope = 1.0f - x;
+        f_sum += 100.0f * valley * valley + slope * slope;
+    }
+
+    return f_sum;
+}
+
+// Ackley, f = -20*exp(-0.2*sqrt(sum(x^2)/n)) - exp(sum(cos(2*pi*x))/n) + 20 + e.
+// Both sums share one unrolled pass, so expf/sqrtf run once per genome.
+static inline float ga_ackley(const float *genes)
+{
+    float sq_sum = 0.0f;
+    float cos_sum = 0.0f;
+
+#pragma GCC unroll 32
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float x = genes[gene];
+        sq_sum += x * x;
+        cos_sum += ga_cos2pi(x);
+    }
+
+    const float inv_n = 1.0f / (float)MAX_GENES;
+    return -20.0f * expf(-0.2f * sqrtf(sq_sum * inv_n)) - expf(cos_sum * inv_n)
+           + 20.0f + 2.71828182845904523536f;
+}
+
+// Schwefel 2.26, f = 418.9829*n - sum(x*sin(sqrt(|x|))). Deceptive, the
+// optimum x = 420.9687 sits next to the domain edge. sin(y) is taken as
+// cos(2*pi*(y/(2*pi) - 1/4)) to reuse ga_cos2pi().
+static inline float ga_schwefel(const float *genes)
+{
+    float f_sum = 0.0f;
+
+#pragma GCC unroll 32
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float x = genes[gene];
+        float turns = sqrtf(fabsf(x)) * (1.0f / GA_TWO_PI_F) - 0.25f;
+        f_sum += x * ga_cos2pi(turns);
+    }
+
+    return 418.98288727f * MAX_GENES - f_sum;
+}
+
+// Griewank, f = 1 + sum(x^2)/4000 - prod(cos(x[i]/sqrt(i+1))). With the
+// loop unrolled each 1/sqrt(i+1) is a compile-time constant.
+static inline float ga_griewank(const float *genes)
+{
+    float f_sum = 0.0f;
+    float f_prod = 1.0f;
+
+#pragma GCC unroll 32
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float x = genes[gene];
+        f_sum += x * x;
+        f_prod *= ga_cos2pi(x * ((1.0f / GA_TWO_PI_F) / sqrtf((float)(gene + 1))));
+    }
+
+    return 1.0f + f_sum * (1.0f / 4000.0f) - f_prod;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GA_FITNESS_H
@@ -0,0 +1,64 @@
+#include "ga_parallel.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+static const char *TAG = "GA_PAR";
+
+#define GA_HELPER_CORE     0
+#define GA_HELPER_PRIORITY 3    // same as the GA task, below the Wi-Fi task
+
+static TaskHandle_t s_helper_handle = NULL;
+static TaskHandle_t s_caller_handle = NULL;
+static ga_parallel_fn_t s_fn;
+static void *s_arg;
+
+// Sleeps on its notification until ga_parallel_run() hands it a job,
+// notifies the caller back when done. Task notifications are the
+// cheapest cross-core wake-up FreeRTOS has.
+static void ga_helper_task(void *pvParameters)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        s_fn(s_arg, 1);
+        xTaskNotifyGive(s_caller_handle);
+    }
+}
+
+esp_err_t ga_parallel_start(void)
+{
+    if (s_helper_handle != NULL) {
+        return ESP_OK;
+    }
+
+    if (xTaskCreatePinnedToCore(ga_helper_task, "GA Helper", 4096, NULL,
+                                GA_HELPER_PRIORITY, &s_helper_handle, GA_HELPER_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create GA helper task");
+        s_helper_handle = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+bool ga_parallel_active(void)
+{
+    return s_helper_handle != NULL;
+}
+
+void ga_parallel_run(ga_parallel_fn_t fn, void *arg)
+{
+    if (s_helper_handle == NULL) {
+        fn(arg, 0);
+        fn(arg, 1);
+        return;
+    }
+
+    s_fn = fn;
+    s_arg = arg;
+    s_caller_handle = xTaskGetCurrentTaskHandle();
+    xTaskNotifyGive(s_helper_handle);
+
+    fn(arg, 0);
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
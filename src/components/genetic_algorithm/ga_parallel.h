@@ -0,0 +1,39 @@
+#ifndef GA_PARALLEL_H
+#define GA_PARALLEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Fork/join helper for splitting one generation of GA work across both
+// ESP32 cores. The GA task is worker 0 on core 1, a helper task pinned
+// to core 0 is worker 1. ga_parallel_run() is the per-generation barrier:
+// it returns once both workers have finished.
+//
+// ga_parallel.c is the FreeRTOS implementation; the host build links
+// src/host/shim/src/ga_parallel_host.cpp (std::thread) instead.
+
+#define GA_PARALLEL_WORKERS 2
+
+typedef void (*ga_parallel_fn_t)(void *arg, int worker);
+
+// Start the helper. Safe to call again once it is running.
+esp_err_t ga_parallel_start(void);
+
+// True once the helper is running.
+bool ga_parallel_active(void);
+
+// Run fn(arg, 0) on the caller and fn(arg, 1) on the helper, and wait for
+// both. Without a helper both run on the caller in worker order, so the
+// result does not depend on whether the helper exists. Not reentrant,
+// only the GA task may call it.
+void ga_parallel_run(ga_parallel_fn_t fn, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GA_PARALLEL_H
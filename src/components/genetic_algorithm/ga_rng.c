@@ -0,0 +1,144 @@
+#include "ga_rng.h"
+#include <math.h>
+#include <stdbool.h>
+
+// Ziggurat tables, Marsaglia & Tsang, "The Ziggurat Method for Generating
+// Random Variables", JSS 2000. Built once on first use, read-only after.
+#define ZIG_LAYERS 128
+#define ZIG_R      3.442619855899     // start of the tail
+#define ZIG_V      9.91256303526217e-3 // area of each layer
+
+static uint32_t s_zig_k[ZIG_LAYERS];
+static float s_zig_w[ZIG_LAYERS];
+static float s_zig_f[ZIG_LAYERS];
+static bool s_zig_ready = false;
+
+static void zig_build_tables(void)
+{
+    const double m1 = 2147483648.0;
+    double dn = ZIG_R;
+    double tn = dn;
+    double q = ZIG_V / exp(-0.5 * dn * dn);
+
+    s_zig_k[0] = (uint32_t)((dn / q) * m1);
+    s_zig_k[1] = 0;
+    s_zig_w[0] = (float)(q / m1);
+    s_zig_w[ZIG_LAYERS - 1] = (float)(dn / m1);
+    s_zig_f[0] = 1.0f;
+    s_zig_f[ZIG_LAYERS - 1] = (float)exp(-0.5 * dn * dn);
+
+    for (int i = ZIG_LAYERS - 2; i >= 1; i--) {
+        dn = sqrt(-2.0 * log(ZIG_V / dn + exp(-0.5 * dn * dn)));
+        s_zig_k[i + 1] = (uint32_t)((dn / tn) * m1);
+        tn = dn;
+        s_zig_f[i] = (float)exp(-0.5 * dn * dn);
+        s_zig_w[i] = (float)(dn / m1);
+    }
+
+    s_zig_ready = true;
+}
+
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void ga_rng_seed(ga_rng_t *rng, uint64_t seed)
+{
+    // SplitMix64 spreads small seeds (the QRNG gives 16 bits) over the
+    // whole state and never produces the all-zero state.
+    uint64_t x = seed;
+    uint64_t a = splitmix64(&x);
+    uint64_t b = splitmix64(&x);
+    rng->s[0] = (uint32_t)a;
+    rng->s[1] = (uint32_t)(a >> 32);
+    rng->s[2] = (uint32_t)b;
+    rng->s[3] = (uint32_t)(b >> 32);
+
+    // The GA seeds before it samples, so building here keeps the tables
+    // off the sampling path without a separate init call.
+    if (!s_zig_ready) {
+        zig_build_tables();
+    }
+}
+
+void ga_rng_jump(ga_rng_t *rng)
+{
+    static const uint32_t jump[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 32; b++) {
+            if (jump[i] & (1u << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            ga_rng_next(rng);
+        }
+    }
+
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+// Uniform in (0, 1), never 0 so it is safe to take the log of.
+static inline float uniform_open(ga_rng_t *rng)
+{
+    return ((float)(ga_rng_next(rng) >> 8) + 0.5f) * (1.0f / 16777216.0f);
+}
+
+// Slow path: the sample landed outside the rectangle of its layer.
+static float zig_fix(ga_rng_t *rng, int32_t hz, uint32_t iz)
+{
+    for (;;) {
+        float x = (float)hz * s_zig_w[iz];
+
+        if (iz == 0) {
+            // Base layer: sample from the tail beyond ZIG_R
+            float y;
+            do {
+                x = -logf(uniform_open(rng)) * (float)(1.0 / ZIG_R);
+                y = -logf(uniform_open(rng));
+            } while (y + y < x * x);
+            return (hz > 0) ? (float)ZIG_R + x : -(float)ZIG_R - x;
+        }
+
+        // Wedge: accept against the density itself
+        if (s_zig_f[iz] + uniform_open(rng) * (s_zig_f[iz - 1] - s_zig_f[iz]) < expf(-0.5f * x * x)) {
+            return x;
+        }
+
+        hz = (int32_t)ga_rng_next(rng);
+        iz = (uint32_t)hz & (ZIG_LAYERS - 1);
+        uint32_t abs_hz = hz < 0 ? (uint32_t)0 - (uint32_t)hz : (uint32_t)hz;
+        if (abs_hz < s_zig_k[iz]) {
+            return (float)hz * s_zig_w[iz];
+        }
+    }
+}
+
+float ga_rng_gaussian(ga_rng_t *rng)
+{
+    int32_t hz = (int32_t)ga_rng_next(rng);
+    uint32_t iz = (uint32_t)hz & (ZIG_LAYERS - 1);
+    uint32_t abs_hz = hz < 0 ? (uint32_t)0 - (uint32_t)hz : (uint32_t)hz;
+
+    if (abs_hz < s_zig_k[iz]) {
+        return (float)hz * s_zig_w[iz];
+    }
+    return zig_fix(rng, hz, iz);
+}
+
+void ga_rng_fill_gaussian(ga_rng_t *rng, float *out, int count, float mean, float sd)
+{
+    for (int i = 0; i < count; i++) {
+        out[i] = mean + sd * ga_rng_gaussian(rng);
+    }
+}
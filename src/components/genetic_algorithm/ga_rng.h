@@ -0,0 +1,78 @@
+#ifndef GA_RNG_H
+#define GA_RNG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Reentrant random number generator for the GA.
+//
+// xoshiro128** (Blackman & Vigna): 128 bits of state, 32-bit output, only
+// shifts/rotates/xors so it is cheap on the ESP32. Every GA owns its own
+// ga_rng_t, so it never shares state with rand() callers in other tasks
+// and a run can be replayed from its seed alone.
+typedef struct {
+    uint32_t s[4];
+} ga_rng_t;
+
+// Expand a seed (e.g. the QRNG / esp_random seed) into a full state.
+void ga_rng_seed(ga_rng_t *rng, uint64_t seed);
+
+// Advance the state by 2^64 draws. Jumping copies of one seeded generator
+// gives non-overlapping streams, e.g. one per worker task.
+void ga_rng_jump(ga_rng_t *rng);
+
+static inline uint32_t ga_rng_rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t ga_rng_next(ga_rng_t *rng)
+{
+    uint32_t *s = rng->s;
+    uint32_t result = ga_rng_rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = ga_rng_rotl(s[3], 11);
+
+    return result;
+}
+
+// Uniform float in [0, 1), 24 bits of resolution.
+static inline float ga_rng_uniform(ga_rng_t *rng)
+{
+    return (float)(ga_rng_next(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Uniform float in [min, max).
+static inline float ga_rng_range(ga_rng_t *rng, float min, float max)
+{
+    return min + ga_rng_uniform(rng) * (max - min);
+}
+
+// Uniform integer in [0, n), Lemire's multiply-shift (bias below 2^-32 * n).
+static inline uint32_t ga_rng_below(ga_rng_t *rng, uint32_t n)
+{
+    return (uint32_t)(((uint64_t)ga_rng_next(rng) * n) >> 32);
+}
+
+// Standard normal sample, Marsaglia & Tsang ziggurat with 128 layers.
+// About 98.8% of draws cost one random number, a table lookup and a
+// multiply; the rest fall back to the wedge/tail test.
+float ga_rng_gaussian(ga_rng_t *rng);
+
+// out[i] = mean + sd * N(0, 1) for i in [0, count).
+void ga_rng_fill_gaussian(ga_rng_t *rng, float *out, int count, float mean, float sd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GA_RNG_H
@@ -9,6 +9,8 @@ extern "C" {
 #include <stdint.h>
 #include <time.h>
 
+// Migration message of firmware before the binary frame below, with the
+// genes as "fitness|gene|gene|..." text. Still accepted on receive.
 typedef struct {
     uint32_t log_id;
     char robot_id[5];
@@ -16,6 +18,35 @@ typedef struct {
     char message[128]; //should be able to handle up to 15 genes
 } out_message_t;
 
+// Binary migration frame (see migration_frame.h in espnow_main), little
+// endian like every robot. The header is followed by gene_count floats,
+// or with MIGRATION_FRAME_QUANTISED the gene range as two floats and an
+// int16_t code per gene (GA_QUANTISED_GENES), then by the CRC-32 of all
+// the bytes before it.
+#define MIGRATION_FRAME_MAGIC0    'M'
+#define MIGRATION_FRAME_MAGIC1    'G'
+#define MIGRATION_FRAME_VERSION   1
+#define MIGRATION_FRAME_QUANTISED 0x01  // flags
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic[2];
+    uint8_t version;
+    uint8_t flags;
+    uint16_t seq;               // per sender, wraps
+    uint8_t gene_count;
+    uint8_t reserved;
+    char robot_id[4];           // not NUL terminated
+    uint32_t log_id;
+    int64_t created_datetime;
+    float fitness;
+} migration_frame_header_t;
+
+#define MIGRATION_FRAME_SIZE(genes, quantised)                                  \
+    (sizeof(migration_frame_header_t) +                                         \
+     ((quantised) ? 2 * sizeof(float) + (genes) * sizeof(int16_t)               \
+                  : (genes) * sizeof(float)) +                                  \
+     sizeof(uint32_t))
+
 typedef struct {
     char experiment_id[16];  // Experiment ID, yyyymmddhhmmss format
     char robot_id[5];        // Robot ID, typically the last 4 digits of MAC address
@@ -29,6 +60,14 @@ typedef struct {
     float robot_speed;      // speed gain used in Pololu
     int pop_size;            // ga population size
     int max_genes;           // ga max genes
+    int num_islands;         // ga sub-populations on this robot
+    int island_migration_interval; // generations between ring migrations
+    char *fitness_function;  // benchmark function optimised, e.g. "RASTRIGIN"
+    float gene_min;          // its search domain, per gene
+    float gene_max;
+    char *engine;            // optimiser engine, e.g. "GA", "DE", "SEP_CMA"
+    float diversity_collapse; // diversity that ends a run early, 0 = off
+    int resumed_generation;  // generation the GA resumed from a checkpoint, 0 = cold start
     time_t experiment_start; // Timestamp for the start of the experiment
     time_t experiment_end;   // Timestamp for the end of the experiment
     int experiment_duration; // Duration in seconds
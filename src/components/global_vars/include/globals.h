@@ -24,26 +24,85 @@ extern SemaphoreHandle_t logCounterMutex;
 extern QueueHandle_t ga_buffer_queue;
 
 //Genetic Algorithm
+//POP_SIZE and MAX_GENES can be overridden at compile time (-DPOP_SIZE=...)
+//so the host benchmark can sweep them without editing this file.
+#ifndef POP_SIZE
 #define POP_SIZE        60      // How many candidate solutions to evaluate.
                                 // More = better search, but slower to compute
                                 // Less = harder for algorithm to find solution
+#endif
                                 
+#ifndef MAX_GENES
 #define MAX_GENES       10       // Dimensions (higher = more difficult)
                                 // This is the number of parameters to be 
                                 // represented in the "genotype" (candidate
                                 // solution).
+#endif
+
+//Genes stored as int16_t codes rather than floats (see ga.h)
+#ifndef GA_QUANTISED_GENES
+#define GA_QUANTISED_GENES 0
+#endif
+
+//POP_SIZE is only the default: the GA arena is sized at init_ga() from
+//g_pop_size, which can be changed before it without reflashing.
+extern int g_pop_size;
+
+//Islands: the population is split into g_num_islands sub-populations at
+//init_ga(), passing their best around a ring every
+//g_island_migration_interval generations (runtime, see ga.h)
+#define DEFAULT_NUM_ISLANDS 1
+#define DEFAULT_ISLAND_MIGRATION_INTERVAL 10
+extern int g_num_islands;
+extern int g_island_migration_interval; // 0 = islands never migrate
+
+//Benchmark function of the current population and its gene bounds, set by
+//init_ga() from g_fitness_function (see ga_fitness.h)
+extern const char *fitness_function;
+extern float gene_min_value;
+extern float gene_max_value;
+//Optimiser engine of the current population, e.g. "DE", set by init_ga()
+//from g_ga_engine (see ga.h)
+extern const char *ga_engine;
 
 #define DEFAULT_MIGRATION_RATE 1 // Number of genome migrated from remote robot
                                 // to local population per generation
 
 #define DEFAULT_GENE_OVERWRITE 0.05f // Percentage of population to overwrite with remote genes
 
+//DEFAULT_PATIENCE and MASS_EXTINCTION_PERCENT can be overridden at compile
+//time like POP_SIZE, for the host convergence suite.
+#ifndef DEFAULT_PATIENCE
 #define DEFAULT_PATIENCE 60
+#endif
 
-#define DEFAULT_MASS_EXTINCTION POP_SIZE/2
+//Share of each island a mass extinction reinitialises. DEFAULT_MASS_EXTINCTION
+//is the row count at the configured g_pop_size, for the run metadata.
+#ifndef MASS_EXTINCTION_PERCENT
+#define MASS_EXTINCTION_PERCENT 50
+#endif
+#define DEFAULT_MASS_EXTINCTION (g_pop_size * MASS_EXTINCTION_PERCENT / 100)
 
 #define DEFAULT_HYPERMUTATION_GENERATIONS 20
 
+//A run also stops once the population diversity (see ga_get_diversity())
+//falls below g_diversity_collapse, after GA_DIVERSITY_GRACE generations
+//without improvement. 0 disables it, leaving only DEFAULT_PATIENCE.
+#ifndef DEFAULT_DIVERSITY_COLLAPSE
+#define DEFAULT_DIVERSITY_COLLAPSE 0.0f
+#endif
+extern float g_diversity_collapse;
+
+//Warm resume: with g_ga_resume set, init_ga() restores the GA from its
+//last checkpoint (see GA_CHECKPOINT in ga.h), skipping the seed fetch and
+//the random population, and only starts cold if there is none. The
+//experiment sets it after a brown-out reset whatever the default.
+#ifndef DEFAULT_GA_RESUME
+#define DEFAULT_GA_RESUME false
+#endif
+extern bool g_ga_resume;
+extern uint32_t ga_resumed_generation; //generation resumed from, 0 = cold start
+
 #define DEFAULT_NUM_ROBOTS 2
 
 #define MSG_UNLIMITED     0
@@ -56,7 +115,15 @@ extern QueueHandle_t ga_buffer_queue;
 
 #define DEFAULT_DATA_LINK "ESPNOW"
 
-#define DEFAULT_ROUTING "UNICAST"
+//Migration routing, runtime like g_pop_size: ROUTING_UNICAST sends a
+//migration to each peer the topology picks, ROUTING_BROADCAST sends it once
+//to every robot in range (see espnow_push_best_solution())
+#define ROUTING_UNICAST     0
+#define ROUTING_BROADCAST   1
+#ifndef DEFAULT_ROUTING
+#define DEFAULT_ROUTING ROUTING_UNICAST
+#endif
+extern int g_routing;
 
 #define DEFAULT_COM_TYPE "DIRECT"
 
@@ -0,0 +1,49 @@
+/* Helpers shared by the host benches: the timer, a sink for results the
+ * compiler must not optimise away, and the options most benches take.
+ * Header only, each bench is a single translation unit.
+ */
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static inline double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Keeps a timed loop's result alive
+static inline void bench_sink(double value)
+{
+    static volatile double sink;
+    sink = value;
+    (void)sink;
+}
+
+// "--iterations N" or "--seed S" (decimal or 0x hex) at argv[*i], for a
+// bench that takes it (pointer not NULL): stores the value, steps *i past
+// it and returns true. Anything else leaves both alone and returns false.
+static inline bool bench_common_arg(int argc, char **argv, int *i, int *iterations, uint32_t *seed)
+{
+    if (*i + 1 >= argc) {
+        return false;
+    }
+    if (iterations != NULL && strcmp(argv[*i], "--iterations") == 0) {
+        *iterations = atoi(argv[++*i]);
+        return true;
+    }
+    if (seed != NULL && strcmp(argv[*i], "--seed") == 0) {
+        *seed = (uint32_t)strtoul(argv[++*i], NULL, 0);
+        return true;
+    }
+    return false;
+}
+
+#endif // BENCH_UTIL_H
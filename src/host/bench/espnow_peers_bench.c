@@ -0,0 +1,270 @@
+/* ESP-NOW peer discovery benchmark for the host build.
+ *
+ * Times a lookup in the hashed peer table (espnow_peers.h) against the
+ * linear memcmp() scan of a MAC list that mac_addr_to_index() did, then
+ * plays a swarm of robots through the table second by second: beaconing
+ * with some loss, leaving and rejoining, and being sent a migration each
+ * second, with the ESP-NOW peer slots stood in for by a set that refuses
+ * more than the hardware limit.
+ *
+ * Exits non-zero if the table disagrees with a model of who was heard
+ * within the timeout, more peers are registered than there are slots, a
+ * send cannot get a slot, a full table takes another robot, or slots are
+ * leaked once the swarm has gone.
+ *
+ * Usage: espnow_peers_bench [--robots N] [--seconds N] [--slots N]
+ *                           [--iterations N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "espnow_peers.h"
+#include "bench_util.h"
+
+#define DEFAULT_ROBOTS     50
+#define DEFAULT_SECONDS    600
+#define DEFAULT_SLOTS      19       // ESP_NOW_MAX_TOTAL_PEER_NUM less the broadcast peer
+#define DEFAULT_ITERATIONS 1000000
+#define MAX_ROBOTS         ESPNOW_PEER_MAX
+#define BEACON_LOSS        10       // percent of beacons lost
+#define LEAVE_CHANCE       2        // percent chance a robot leaves in a second
+#define RETURN_CHANCE      10       // percent chance an absent robot returns
+
+typedef struct {
+    int robots;
+    int seconds;
+    int slots;
+    int iterations;
+} bench_args_t;
+
+typedef struct {
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    bool present;
+    bool registered;                // with the fake ESP-NOW
+    bool heard;                     // ever, by the model
+    uint32_t last_heard_ms;
+} robot_t;
+
+static robot_t s_robots[MAX_ROBOTS + 8];
+static int s_robot_count;
+static int s_registered;
+static int s_slot_limit;
+static int s_slot_errors;
+static void parse_args(int argc, char **argv, bench_args_t *args)
+{
+    args->robots = DEFAULT_ROBOTS;
+    args->seconds = DEFAULT_SECONDS;
+    args->slots = DEFAULT_SLOTS;
+    args->iterations = DEFAULT_ITERATIONS;
+
+    for (int i = 1; i < argc; i++) {
+        if (bench_common_arg(argc, argv, &i, &args->iterations, NULL)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--robots") && i + 1 < argc) {
+            args->robots = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            args->seconds = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--slots") && i + 1 < argc) {
+            args->slots = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--robots N] [--seconds N] [--slots N] [--iterations N]\n",
+                    argv[0]);
+            exit(2);
+        }
+    }
+    if (args->robots < 1) args->robots = 1;
+    if (args->robots > MAX_ROBOTS) args->robots = MAX_ROBOTS;
+    if (args->seconds < 1) args->seconds = 1;
+    if (args->slots < 1) args->slots = 1;
+    if (args->iterations < 1) args->iterations = 1;
+}
+
+static robot_t *robot_by_mac(const uint8_t mac[ESP_NOW_ETH_ALEN])
+{
+    for (int i = 0; i < s_robot_count; i++) {
+        if (memcmp(s_robots[i].mac, mac, ESP_NOW_ETH_ALEN) == 0) {
+            return &s_robots[i];
+        }
+    }
+    return NULL;
+}
+
+// The fake ESP-NOW peer list: refuses past the limit, like the real one
+static bool fake_add(const uint8_t mac[ESP_NOW_ETH_ALEN], void *arg)
+{
+    (void)arg;
+    robot_t *r = robot_by_mac(mac);
+    if (r == NULL || r->registered || s_registered >= s_slot_limit) {
+        s_slot_errors++;
+        return false;
+    }
+    r->registered = true;
+    s_registered++;
+    return true;
+}
+
+static void fake_del(const uint8_t mac[ESP_NOW_ETH_ALEN], void *arg)
+{
+    (void)arg;
+    robot_t *r = robot_by_mac(mac);
+    if (r == NULL || !r->registered) {
+        s_slot_errors++;
+        return;
+    }
+    r->registered = false;
+    s_registered--;
+}
+
+// Same vendor prefix for every robot, as in a real swarm
+static void make_robots(int count)
+{
+    s_robot_count = count;
+    for (int i = 0; i < count; i++) {
+        robot_t *r = &s_robots[i];
+        memset(r, 0, sizeof(*r));
+        r->mac[0] = 0x78;
+        r->mac[1] = 0x21;
+        r->mac[2] = 0x84;
+        do {
+            r->mac[3] = (uint8_t)rand();
+            r->mac[4] = (uint8_t)rand();
+            r->mac[5] = (uint8_t)rand();
+        } while (robot_by_mac(r->mac) != r);
+        r->present = true;
+    }
+}
+
+static int check_table(espnow_peer_table_t *table, uint32_t now_ms, int second)
+{
+    int expected = 0;
+    for (int i = 0; i < s_robot_count; i++) {
+        robot_t *r = &s_robots[i];
+        bool known = r->heard && now_ms - r->last_heard_ms <= ESPNOW_PEER_TIMEOUT_MS;
+        espnow_peer_t *peer = espnow_peer_find(table, r->mac);
+        expected += known;
+        if (known != (peer != NULL) || (peer != NULL && peer->registered != r->registered)) {
+            printf("second %d: robot %d %s, table has it %s\n", second, i,
+                   known ? "heard" : "timed out", peer ? "registered or not wrongly" : "missing");
+            return 1;
+        }
+    }
+    if (table->count != expected || table->registered != s_registered ||
+        s_registered > s_slot_limit) {
+        printf("second %d: %d peers for %d expected, %d registered of %d slots\n", second,
+               table->count, expected, s_registered, s_slot_limit);
+        return 1;
+    }
+    return 0;
+}
+
+static int check_limits(void)
+{
+    static espnow_peer_table_t table;
+    const espnow_peer_slots_t ops = { fake_add, fake_del, NULL };
+
+    make_robots(MAX_ROBOTS + 5);
+    s_registered = 0;
+    s_slot_limit = DEFAULT_SLOTS;
+    espnow_peers_init(&table, s_robots[0].mac, s_slot_limit, &ops);
+    if (espnow_peer_seen(&table, s_robots[0].mac, -40, 1) != NULL) {
+        printf("own MAC taken as a peer\n");
+        return 1;
+    }
+    for (int i = 1; i < s_robot_count; i++) {
+        espnow_peer_seen(&table, s_robots[i].mac, -40, 1);
+    }
+    if (table.count != ESPNOW_PEER_MAX || table.stats.refused != 4) {
+        printf("full table: %d peers, %u refused\n", table.count, (unsigned)table.stats.refused);
+        return 1;
+    }
+    // Everyone times out but one, heard again later
+    espnow_peer_seen(&table, s_robots[7].mac, -40, 5000);
+    int evicted = espnow_peers_expire(&table, 5000 + ESPNOW_PEER_TIMEOUT_MS, ESPNOW_PEER_TIMEOUT_MS);
+    if (evicted != ESPNOW_PEER_MAX - 1 || table.count != 1 ||
+        espnow_peer_find(&table, s_robots[7].mac) == NULL) {
+        printf("expiry: %d evicted, %d left\n", evicted, table.count);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_args_t args;
+    parse_args(argc, argv, &args);
+    srand(1);
+
+    if (check_limits() != 0) {
+        return 1;
+    }
+
+    // Lookups: the hash table against the old linear scan. robots[0] is us.
+    static espnow_peer_table_t table;
+    const espnow_peer_slots_t ops = { fake_add, fake_del, NULL };
+    make_robots(args.robots + 1);
+    s_registered = 0;
+    s_slot_limit = args.slots;
+    espnow_peers_init(&table, s_robots[0].mac, args.slots, &ops);
+    for (int i = 1; i < s_robot_count; i++) {
+        espnow_peer_seen(&table, s_robots[i].mac, -50, 1);
+    }
+    int acc = 0;
+    double t0 = now_ns();
+    for (int i = 0; i < args.iterations; i++) {
+        acc += espnow_peer_find(&table, s_robots[1 + i % args.robots].mac) != NULL;
+    }
+    double hash_ns = (now_ns() - t0) / args.iterations;
+    t0 = now_ns();
+    for (int i = 0; i < args.iterations; i++) {
+        acc += robot_by_mac(s_robots[1 + i % args.robots].mac) != NULL;
+    }
+    double scan_ns = (now_ns() - t0) / args.iterations;
+    bench_sink(acc);
+    printf("%-20s %12.1f ns/lookup, %d peers\n", "peers/hash", hash_ns, args.robots);
+    printf("%-20s %12.1f ns/lookup\n", "peers/scan", scan_ns);
+
+    // The swarm over time, one beacon per robot per second
+    espnow_peers_init(&table, s_robots[0].mac, args.slots, &ops);
+    int sends = 0, failed_sends = 0;
+    uint32_t now_ms = 0;
+    for (int second = 0; second < args.seconds; second++) {
+        now_ms = (uint32_t)second * 1000;
+        for (int i = 1; i < s_robot_count; i++) {
+            robot_t *r = &s_robots[i];
+            if (r->present ? rand() % 100 < LEAVE_CHANCE : rand() % 100 < RETURN_CHANCE) {
+                r->present = !r->present;
+            }
+            if (r->present && rand() % 100 >= BEACON_LOSS) {
+                espnow_peer_seen(&table, r->mac, (int8_t)(-30 - rand() % 60), now_ms);
+                r->heard = true;
+                r->last_heard_ms = now_ms;
+            }
+        }
+        // The throughput timer, then a migration to every peer
+        espnow_peers_expire(&table, now_ms, ESPNOW_PEER_TIMEOUT_MS);
+        static espnow_peer_t snapshot[ESPNOW_PEER_MAX];
+        int peer_count = espnow_peers_list(&table, snapshot, ESPNOW_PEER_MAX);
+        for (int i = 0; i < peer_count; i++) {
+            espnow_peer_t *peer = espnow_peer_find(&table, snapshot[i].mac);
+            sends++;
+            failed_sends += !espnow_peer_claim_slot(&table, peer, now_ms);
+        }
+        if (check_table(&table, now_ms, second) != 0) {
+            return 1;
+        }
+    }
+    printf("%-20s %12u joined, %u evicted, %u rotations, %d sends over %d seconds\n", "peers/swarm",
+           (unsigned)table.stats.joined, (unsigned)table.stats.evicted,
+           (unsigned)table.stats.rotations, sends, args.seconds);
+
+    // Everyone leaves: the table empties and hands every slot back
+    espnow_peers_expire(&table, now_ms + ESPNOW_PEER_TIMEOUT_MS + 1, ESPNOW_PEER_TIMEOUT_MS);
+    if (failed_sends != 0 || s_slot_errors != 0 || table.count != 0 || s_registered != 0) {
+        printf("peer swarm FAILED: %d sends without a slot, %d slot errors, %d peers and %d slots left\n",
+               failed_sends, s_slot_errors, table.count, s_registered);
+        return 1;
+    }
+    return 0;
+}
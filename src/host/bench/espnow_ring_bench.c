@@ -0,0 +1,263 @@
+/* ESP-NOW callback handoff benchmark for the host build.
+ *
+ * Plays the Wi-Fi task against espnow_task: a producer pushes events in
+ * bursts, as when several robots migrate at once, into a ring
+ * (espnow_ring.h) and wakes the consumer with a task notification. The
+ * consumer spends a little time on each event and now and then stalls for
+ * a few milliseconds, as it does behind ESP_LOGI() or a full LogQueue.
+ *
+ * Run once per ring capacity, the drops and high water are the sizing
+ * report for ESPNOW_SEND_RING_SIZE and ESPNOW_RECV_RING_SIZE. The same
+ * load then goes through the old handoff, a blocking xQueueSend() into a
+ * queue of ESPNOW_QUEUE_SIZE, to compare how long the producer is held.
+ *
+ * Exits non-zero if an event is lost without being counted as a drop, or
+ * events reach the consumer out of order.
+ *
+ * Usage: espnow_ring_bench [--events N] [--burst N] [--period-us N]
+ *                          [--work-us N] [--stall-ms N] [--stall-every N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "espnow_main.h"
+#include "bench_util.h"
+
+#define DEFAULT_EVENTS      20000
+#define DEFAULT_BURST       8       // events arriving back to back
+#define DEFAULT_PERIOD_US   5000    // between bursts
+#define DEFAULT_WORK_US     20      // per event in espnow_task
+#define DEFAULT_STALL_MS    5
+#define DEFAULT_STALL_EVERY 256
+#define OLD_QUEUE_WAIT      512     // ESPNOW_MAXDELAY of the old callbacks
+#define MAX_CAPACITY        32
+
+typedef struct {
+    int events;
+    int burst;
+    int period_us;
+    int work_us;
+    int stall_ms;
+    int stall_every;
+} bench_args_t;
+
+typedef struct {
+    const bench_args_t *args;
+    espnow_ring_t *ring;            // NULL for the queue handoff
+    QueueHandle_t queue;
+    volatile bool done;             // producer finished
+    volatile bool exited;
+    int consumed;
+    int out_of_order;
+} consumer_t;
+
+typedef struct {
+    int dropped;
+    double max_push_us;
+    double mean_push_us;
+} producer_result_t;
+
+static void spin_us(int us)
+{
+    double until = now_ns() + us * 1e3;
+    while (now_ns() < until) {
+    }
+}
+
+static void sleep_us(int us)
+{
+    struct timespec ts = { us / 1000000, (long)(us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+static void parse_args(int argc, char **argv, bench_args_t *args)
+{
+    args->events = DEFAULT_EVENTS;
+    args->burst = DEFAULT_BURST;
+    args->period_us = DEFAULT_PERIOD_US;
+    args->work_us = DEFAULT_WORK_US;
+    args->stall_ms = DEFAULT_STALL_MS;
+    args->stall_every = DEFAULT_STALL_EVERY;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+            args->events = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--burst") && i + 1 < argc) {
+            args->burst = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--period-us") && i + 1 < argc) {
+            args->period_us = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--work-us") && i + 1 < argc) {
+            args->work_us = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--stall-ms") && i + 1 < argc) {
+            args->stall_ms = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--stall-every") && i + 1 < argc) {
+            args->stall_every = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--events N] [--burst N] [--period-us N] [--work-us N] "
+                            "[--stall-ms N] [--stall-every N]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (args->events < 1) args->events = 1;
+    if (args->burst < 1) args->burst = 1;
+    if (args->stall_every < 1) args->stall_every = 1;
+}
+
+// The event number travels in mac_addr, as in espnow_slab_bench
+static void handle_event(consumer_t *c, const example_espnow_event_t *evt, int *last)
+{
+    int n;
+    memcpy(&n, evt->info.send_cb.mac_addr, sizeof(n));
+    c->out_of_order += n <= *last;
+    *last = n;
+    c->consumed++;
+
+    spin_us(c->args->work_us);
+    if (c->consumed % c->args->stall_every == 0) {
+        sleep_us(c->args->stall_ms * 1000);
+    }
+}
+
+// Stands in for espnow_task
+static void consumer_task(void *arg)
+{
+    consumer_t *c = arg;
+    example_espnow_event_t evt;
+    int last = -1;
+
+    for (;;) {
+        // Read before looking for events, so none pushed before it is missed
+        bool finished = c->done;
+        if (c->ring != NULL) {
+            if (espnow_ring_pop(c->ring, &evt)) {
+                handle_event(c, &evt, &last);
+            } else if (finished) {
+                break;
+            } else {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+        } else if (xQueueReceive(c->queue, &evt, 1) == pdTRUE) {
+            handle_event(c, &evt, &last);
+        } else if (finished) {
+            break;
+        }
+    }
+    c->exited = true;
+    vTaskDelete(NULL);
+}
+
+// Stands in for the Wi-Fi task calling example_espnow_send_cb()
+static void produce(consumer_t *c, TaskHandle_t consumer, producer_result_t *result)
+{
+    const bench_args_t *args = c->args;
+    example_espnow_event_t evt = { .id = EXAMPLE_ESPNOW_SEND_CB };
+    double total_ns = 0.0, max_ns = 0.0;
+
+    result->dropped = 0;
+    for (int n = 0; n < args->events; n++) {
+        memcpy(evt.info.send_cb.mac_addr, &n, sizeof(n));
+        double t0 = now_ns();
+        if (c->ring != NULL) {
+            if (espnow_ring_push(c->ring, &evt)) {
+                xTaskNotifyGive(consumer);
+            } else {
+                result->dropped++;
+            }
+        } else if (xQueueSend(c->queue, &evt, OLD_QUEUE_WAIT) != pdTRUE) {
+            result->dropped++;
+        }
+        double dt = now_ns() - t0;
+        total_ns += dt;
+        if (dt > max_ns) {
+            max_ns = dt;
+        }
+        if ((n + 1) % args->burst == 0) {
+            sleep_us(args->period_us);
+        }
+    }
+    result->max_push_us = max_ns / 1e3;
+    result->mean_push_us = total_ns / args->events / 1e3;
+}
+
+static int run(const bench_args_t *args, espnow_ring_t *ring, QueueHandle_t queue,
+               producer_result_t *result, consumer_t *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->args = args;
+    c->ring = ring;
+    c->queue = queue;
+
+    TaskHandle_t consumer = NULL;
+    xTaskCreate(consumer_task, "espnow_task", 4096, c, 4, &consumer);
+    produce(c, consumer, result);
+    c->done = true;
+    xTaskNotifyGive(consumer);
+    while (!c->exited) {
+        sleep_us(1000);
+    }
+
+    if (c->out_of_order != 0 || c->consumed + result->dropped != args->events) {
+        printf("handoff FAILED: %d consumed, %d dropped of %d, %d out of order\n", c->consumed,
+               result->dropped, args->events, c->out_of_order);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_args_t args;
+    parse_args(argc, argv, &args);
+    esp_log_level_set("*", ESP_LOG_ERROR);
+
+    static example_espnow_event_t items[MAX_CAPACITY];
+    static const uint32_t capacities[] = { 4, 8, 16, MAX_CAPACITY };
+    producer_result_t result;
+    consumer_t consumer;
+
+    printf("%-20s %12d events, bursts of %d every %d us, %d us each, %d ms stall every %d\n",
+           "load", args.events, args.burst, args.period_us, args.work_us, args.stall_ms,
+           args.stall_every);
+
+    for (size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++) {
+        espnow_ring_t ring;
+        espnow_ring_stats_t stats;
+        espnow_ring_init(&ring, items, sizeof(example_espnow_event_t), capacities[i]);
+        if (run(&args, &ring, NULL, &result, &consumer) != 0) {
+            return 1;
+        }
+        espnow_ring_get_stats(&ring, &stats);
+        if (stats.drops != (uint32_t)result.dropped || stats.pushed != (uint32_t)consumer.consumed ||
+            stats.waiting != 0 || stats.high_water > stats.capacity) {
+            printf("ring stats FAILED: %u pushed, %u drops, %u waiting, %u high water\n",
+                   (unsigned)stats.pushed, (unsigned)stats.drops, (unsigned)stats.waiting,
+                   (unsigned)stats.high_water);
+            return 1;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "ring/%u", (unsigned)capacities[i]);
+        printf("%-20s %12d dropped (%.2f%%), %u high water, push max %.1f us, mean %.2f us\n", name,
+               result.dropped, 100.0 * result.dropped / args.events, (unsigned)stats.high_water,
+               result.max_push_us, result.mean_push_us);
+    }
+
+    // The old callbacks waited up to ESPNOW_MAXDELAY ticks for a queue slot
+    QueueHandle_t queue = xQueueCreate(ESPNOW_QUEUE_SIZE, sizeof(example_espnow_event_t));
+    if (run(&args, NULL, queue, &result, &consumer) != 0) {
+        return 1;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "queue/%d", ESPNOW_QUEUE_SIZE);
+    printf("%-20s %12d dropped (%.2f%%), blocking send, push max %.1f us, mean %.2f us\n", name,
+           result.dropped, 100.0 * result.dropped / args.events, result.max_push_us,
+           result.mean_push_us);
+    vQueueDelete(queue);
+    return 0;
+}
@@ -0,0 +1,235 @@
+/* ESP-NOW receive pool benchmark for the host build.
+ *
+ * Times a frame through the receive pool (espnow_slab.h), allocated,
+ * copied and released, against the malloc()/memcpy()/free() the receive
+ * callback used before, then runs the pool the way the firmware does: a
+ * "Wi-Fi" task allocating frames and passing their handles through a
+ * queue of ESPNOW_QUEUE_SIZE to a consumer that, like
+ * drain_buffered_messages(), holds on to the best one it has seen.
+ *
+ * Exits non-zero if the pool hands out a slot twice, a frame is corrupted
+ * in flight, exhaustion or oversize frames are not refused and counted,
+ * or a slot is still in use at the end.
+ *
+ * Usage: espnow_slab_bench [--frames N] [--iterations N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "espnow_main.h"
+#include "bench_util.h"
+
+#define DEFAULT_FRAMES     200000
+#define DEFAULT_ITERATIONS 1000000
+#define FRAME_BYTES        72       // a raw 10 gene migration frame
+
+typedef struct {
+    int frames;
+    int iterations;
+} bench_args_t;
+
+typedef struct {
+    QueueHandle_t queue;
+    int frames;
+    volatile int dropped;           // refused by the pool
+    volatile bool done;
+} producer_t;
+
+static void parse_args(int argc, char **argv, bench_args_t *args)
+{
+    args->frames = DEFAULT_FRAMES;
+    args->iterations = DEFAULT_ITERATIONS;
+
+    for (int i = 1; i < argc; i++) {
+        if (bench_common_arg(argc, argv, &i, &args->iterations, NULL)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            args->frames = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--frames N] [--iterations N]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (args->frames < 1) args->frames = 1;
+    if (args->iterations < 1) args->iterations = 1;
+}
+
+// Frame n: its length and every byte follow from n
+static int fill_frame(uint8_t *buf, int n)
+{
+    int len = 1 + n % (int)ESPNOW_SLAB_FRAME_BYTES;
+    memset(buf, (uint8_t)n, len);
+    return len;
+}
+
+static bool frame_intact(const espnow_frame_t *frame, int n)
+{
+    if (frame->len != 1 + n % (int)ESPNOW_SLAB_FRAME_BYTES) {
+        return false;
+    }
+    for (int i = 0; i < frame->len; i++) {
+        if (frame->data[i] != (uint8_t)n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Stands in for example_espnow_recv_cb(): never waits for a slot, drops
+// the frame instead. The frame number travels in mac_addr.
+static void producer_task(void *arg)
+{
+    producer_t *p = arg;
+    uint8_t buf[ESPNOW_SLAB_FRAME_BYTES];
+    for (int n = 0; n < p->frames; n++) {
+        example_espnow_event_t evt;
+        evt.id = EXAMPLE_ESPNOW_RECV_CB;
+        memcpy(evt.info.recv_cb.mac_addr, &n, sizeof(n));
+        evt.info.recv_cb.frame = espnow_frame_alloc(buf, fill_frame(buf, n));
+        if (evt.info.recv_cb.frame == NULL) {
+            p->dropped++;
+            continue;
+        }
+        if (xQueueSend(p->queue, &evt, portMAX_DELAY) != pdTRUE) {
+            espnow_frame_release(evt.info.recv_cb.frame);
+        }
+    }
+    p->done = true;
+    vTaskDelete(NULL);
+}
+
+static int check_limits(void)
+{
+    uint8_t buf[ESPNOW_SLAB_FRAME_BYTES + 1] = {0};
+    espnow_frame_t *frames[ESPNOW_SLAB_FRAMES];
+    espnow_slab_stats_t stats;
+
+    espnow_slab_init();
+    for (int i = 0; i < ESPNOW_SLAB_FRAMES; i++) {
+        frames[i] = espnow_frame_alloc(buf, FRAME_BYTES);
+        for (int j = 0; j < i; j++) {
+            if (frames[i] == NULL || frames[i] == frames[j]) {
+                printf("slot %d handed out twice or not at all\n", i);
+                return 1;
+            }
+        }
+    }
+    espnow_frame_t *extra = espnow_frame_alloc(buf, FRAME_BYTES);
+    espnow_frame_t *big = espnow_frame_alloc(buf, sizeof(buf));
+    espnow_slab_get_stats(&stats);
+    if (extra != NULL || big != NULL || stats.exhausted != 1 || stats.oversize != 1 ||
+        stats.in_use != ESPNOW_SLAB_FRAMES) {
+        printf("full pool not refused: exhausted %u, oversize %u, in use %u\n",
+               (unsigned)stats.exhausted, (unsigned)stats.oversize, (unsigned)stats.in_use);
+        return 1;
+    }
+
+    // A retained frame outlives its first release
+    espnow_frame_retain(frames[0]);
+    espnow_frame_release(frames[0]);
+    if (espnow_frame_alloc(buf, FRAME_BYTES) != NULL) {
+        printf("retained slot reused\n");
+        return 1;
+    }
+    for (int i = 0; i < ESPNOW_SLAB_FRAMES; i++) {
+        espnow_frame_release(frames[i]);
+    }
+    espnow_slab_get_stats(&stats);
+    if (stats.in_use != 0 || stats.high_water != ESPNOW_SLAB_FRAMES) {
+        printf("slots leaked: %u in use\n", (unsigned)stats.in_use);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    bench_args_t args;
+    parse_args(argc, argv, &args);
+    esp_log_level_set("*", ESP_LOG_ERROR);
+
+    if (check_limits() != 0) {
+        return 1;
+    }
+    printf("%-20s %12d slots of %u bytes, %u bytes\n", "slab/pool", ESPNOW_SLAB_FRAMES,
+           (unsigned)ESPNOW_SLAB_FRAME_BYTES, (unsigned)(ESPNOW_SLAB_FRAMES * sizeof(espnow_frame_t)));
+
+    // One frame in and out, as the receive callback and espnow_task do
+    uint8_t buf[FRAME_BYTES];
+    memset(buf, 0x5A, sizeof(buf));
+    int acc = 0;
+    espnow_slab_init();
+    double t0 = now_ns();
+    for (int i = 0; i < args.iterations; i++) {
+        espnow_frame_t *frame = espnow_frame_alloc(buf, sizeof(buf));
+        acc += frame->data[i % FRAME_BYTES];
+        espnow_frame_release(frame);
+    }
+    double slab_ns = (now_ns() - t0) / args.iterations;
+    t0 = now_ns();
+    for (int i = 0; i < args.iterations; i++) {
+        uint8_t *data = malloc(sizeof(buf));
+        memcpy(data, buf, sizeof(buf));
+        acc += ((volatile uint8_t *)data)[i % FRAME_BYTES];
+        free(data);
+    }
+    double malloc_ns = (now_ns() - t0) / args.iterations;
+    bench_sink(acc);
+    printf("%-20s %12.1f ns/frame\n", "slab/alloc", slab_ns);
+    printf("%-20s %12.1f ns/frame\n", "malloc/alloc", malloc_ns);
+
+    // Producer and consumer on two threads through the firmware queue depth
+    espnow_slab_init();
+    producer_t producer = {
+        .queue = xQueueCreate(ESPNOW_QUEUE_SIZE, sizeof(example_espnow_event_t)),
+        .frames = args.frames,
+    };
+    xTaskCreate(producer_task, "wifi", 4096, &producer, 5, NULL);
+
+    espnow_frame_t *held = NULL;
+    int held_n = -1, received = 0, corrupt = 0;
+    example_espnow_event_t evt;
+    while (!producer.done || uxQueueMessagesWaiting(producer.queue) > 0) {
+        if (xQueueReceive(producer.queue, &evt, 1) != pdTRUE) {
+            continue;
+        }
+        int n;
+        memcpy(&n, evt.info.recv_cb.mac_addr, sizeof(n));
+        espnow_frame_t *frame = evt.info.recv_cb.frame;
+        corrupt += !frame_intact(frame, n);
+        // Keep every 16th like the best buffered migrant, still intact
+        if (n % 16 == 0) {
+            if (held != NULL) {
+                corrupt += !frame_intact(held, held_n);
+            }
+            espnow_frame_release(held);
+            held = espnow_frame_retain(frame);
+            held_n = n;
+        }
+        espnow_frame_release(frame);
+        received++;
+    }
+    if (held != NULL) {
+        corrupt += !frame_intact(held, held_n);
+    }
+    espnow_frame_release(held);
+
+    espnow_slab_stats_t stats;
+    espnow_slab_get_stats(&stats);
+    printf("%-20s %12d frames, %d dropped, %u high water, %d corrupt\n", "slab/stress", received,
+           producer.dropped, (unsigned)stats.high_water, corrupt);
+    if (corrupt != 0 || stats.in_use != 0 || received + producer.dropped != args.frames ||
+        stats.exhausted != (uint32_t)producer.dropped) {
+        printf("slab stress FAILED: %u still in use, %u exhausted\n", (unsigned)stats.in_use,
+               (unsigned)stats.exhausted);
+        return 1;
+    }
+    vQueueDelete(producer.queue);
+    return 0;
+}
@@ -0,0 +1,688 @@
+/* GA micro-benchmark for the host build.
+ *
+ * Times the individual GA stages in ga.c and a full evolve() generation.
+ * MAX_GENES is fixed per binary, the population size is picked at run time
+ * with --pop (default POP_SIZE). Run the ga_bench_sweep target to get every
+ * configured pair in one go.
+ *
+ * Usage: ga_bench_g<GENES> [--pop N] [--iterations N] [--generations N]
+ *                          [--worker-runs N] [--seed S]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "globals.h"
+#include "ga.h"
+#include "ga_fitness.h"
+#include "ga_rng.h"
+#include "ga_parallel.h"
+#include "ga_host.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "bench_util.h"
+
+#define DEFAULT_ITERATIONS   2000
+#define DEFAULT_GENERATIONS  2000
+#define DEFAULT_WORKER_RUNS  3
+#define DEFAULT_SEED         12345u
+#define ISLAND_SEEDS         5
+#define ISLAND_TARGET        20.0f  // Rastrigin value timed to in the island comparison
+
+typedef struct {
+    int pop;
+    int iterations;
+    int generations;
+    int worker_runs;
+    uint32_t seed;
+} bench_args_t;
+
+typedef struct {
+    volatile bool stop;
+    volatile bool done;
+    uint32_t reads;
+    uint32_t torn;      // genes and fitness from different generations
+    uint32_t backwards; // generation went down
+} snapshot_reader_t;
+
+// Reads the published best in a loop while main() evolves. A consistent
+// copy always satisfies fitness == ga_evaluate(genes).
+static void snapshot_reader_task(void *arg)
+{
+    snapshot_reader_t *r = arg;
+    ga_best_snapshot_t snap;
+    uint32_t last_generation = 0;
+
+    while (!r->stop) {
+        ga_get_best_snapshot(&snap);
+        if (ga_evaluate(snap.genes) != snap.fitness) {
+            r->torn++;
+        }
+        if (snap.generation < last_generation) {
+            r->backwards++;
+        }
+        last_generation = snap.generation;
+        r->reads++;
+    }
+    r->done = true;
+    vTaskDelete(NULL);
+}
+
+static void parse_args(int argc, char **argv, bench_args_t *args)
+{
+    args->pop = POP_SIZE;
+    args->iterations = DEFAULT_ITERATIONS;
+    args->generations = DEFAULT_GENERATIONS;
+    args->worker_runs = DEFAULT_WORKER_RUNS;
+    args->seed = DEFAULT_SEED;
+
+    for (int i = 1; i < argc; i++) {
+        if (bench_common_arg(argc, argv, &i, &args->iterations, &args->seed)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--pop") && i + 1 < argc) {
+            args->pop = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--generations") && i + 1 < argc) {
+            args->generations = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--worker-runs") && i + 1 < argc) {
+            args->worker_runs = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--pop N] [--iterations N] [--generations N] [--worker-runs N] [--seed S]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (args->iterations < 1) args->iterations = 1;
+    if (args->generations < 1) args->generations = 1;
+}
+
+// Fresh, ranked population so every stage starts from the same state.
+static void reset_ga(uint32_t seed)
+{
+    host_esp_random_seed(seed);
+    if (init_ga(false) != ESP_OK) {
+        printf("init_ga failed for --pop %d\n", g_pop_size);
+        exit(1);
+    }
+    determineFitness();
+    createRanking();
+}
+
+static void report(const char *stage, double total_ns, int calls)
+{
+    printf("%-20s %12.1f ns/call\n", stage, total_ns / calls);
+}
+
+// Generations the replay checks run, short enough for every engine.
+static int replay_generations(const bench_args_t *args)
+{
+    return args->generations < 200 ? args->generations : 200;
+}
+
+// Best after evolving a fresh GA from seed for the given generations.
+static float evolve_best(uint32_t seed, int generations)
+{
+    reset_ga(seed);
+    for (int i = 0; i < generations; i++) {
+        evolve();
+    }
+    return ga_get_local_best_fitness();
+}
+
+static void bench_stages(const bench_args_t *args)
+{
+    reset_ga(args->seed);
+    double t0 = now_ns();
+    for (int i = 0; i < args->iterations; i++) {
+        ga_invalidate_fitness();    // time the full kernel, not the cache
+        determineFitness();
+    }
+    report("determineFitness", now_ns() - t0, args->iterations);
+
+    reset_ga(args->seed);
+    t0 = now_ns();
+    for (int i = 0; i < args->iterations; i++) {
+        createRanking();
+    }
+    report("createRanking", now_ns() - t0, args->iterations);
+
+    ga_rng_t rng;
+    ga_rng_seed(&rng, args->seed);
+    float noise[MAX_GENES];
+    float facc = 0.0f;
+    int samples = args->iterations * args->pop * MAX_GENES;
+    t0 = now_ns();
+    for (int i = 0; i < samples; i++) {
+        facc += ga_rng_uniform(&rng);
+    }
+    report("rng/uniform", now_ns() - t0, samples);
+    t0 = now_ns();
+    for (int i = 0; i < samples; i++) {
+        facc += ga_rng_gaussian(&rng);
+    }
+    report("rng/gaussian", now_ns() - t0, samples);
+    t0 = now_ns();
+    for (int i = 0; i < samples / MAX_GENES; i++) {
+        ga_rng_fill_gaussian(&rng, noise, MAX_GENES, MUTATE_MEAN, MUTATE_WIDTH);
+        facc += noise[0];
+    }
+    report("rng/fill_gaussian", now_ns() - t0, (samples / MAX_GENES) * MAX_GENES);
+    bench_sink(facc);
+}
+
+static void bench_selection(const bench_args_t *args)
+{
+    static const struct {
+        ga_selection_mode_t mode;
+        const char *name;
+    } modes[] = {
+        { GA_SELECTION_ROULETTE, "roulette" },
+        { GA_SELECTION_ALIAS,    "alias" },
+        { GA_SELECTION_SUS,      "sus" },
+    };
+    int draws = args->iterations * args->pop;
+    int how_many = (int)(args->pop * PERCENT_CHILD);
+    int *parents = malloc(sizeof(int) * args->pop);
+    char label[32];
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        g_selection_mode = modes[m].mode;
+
+        // Table build is once per generation, draws are per parent
+        reset_ga(args->seed);
+        double t0 = now_ns();
+        for (int i = 0; i < args->iterations; i++) {
+            prepareSelection();
+        }
+        snprintf(label, sizeof(label), "prepare/%s", modes[m].name);
+        report(label, now_ns() - t0, args->iterations);
+
+        int acc = 0;
+        if (modes[m].mode == GA_SELECTION_SUS) {
+            t0 = now_ns();
+            for (int i = 0; i < args->iterations; i++) {
+                susSelection(parents, how_many);
+                acc += parents[0];
+            }
+            snprintf(label, sizeof(label), "select/%s", modes[m].name);
+            report(label, now_ns() - t0, args->iterations * how_many);
+        } else {
+            t0 = now_ns();
+            for (int i = 0; i < draws; i++) {
+                acc += rouletteSelection();
+            }
+            snprintf(label, sizeof(label), "select/%s", modes[m].name);
+            report(label, now_ns() - t0, draws);
+        }
+        bench_sink(acc);
+
+        reset_ga(args->seed);
+        t0 = now_ns();
+        for (int i = 0; i < args->generations; i++) {
+            evolve();
+        }
+        double evolve_ns = now_ns() - t0;
+        snprintf(label, sizeof(label), "evolve/%s", modes[m].name);
+        report(label, evolve_ns, args->generations);
+        snprintf(label, sizeof(label), "throughput/%s", modes[m].name);
+        printf("%-20s %12.1f generations/sec\n", label, args->generations * 1e9 / evolve_ns);
+        ga_fitness_stats_t fstats;
+        ga_get_fitness_stats(&fstats);
+        snprintf(label, sizeof(label), "evals/%s", modes[m].name);
+        printf("%-20s %12u evaluated, %u skipped (%.1f%%)\n", label, (unsigned)fstats.evaluated,
+               (unsigned)fstats.skipped, 100.0 * fstats.skipped / (fstats.evaluated + fstats.skipped));
+        snprintf(label, sizeof(label), "best/%s", modes[m].name);
+        printf("%-20s %12.3f\n", label, ga_get_local_best_fitness());
+    }
+
+    free(parents);
+    g_selection_mode = GA_SELECTION_ROULETTE;
+}
+
+// The GA draws only from its own seeded generator, so a replay of
+// the same seed must land on exactly the same best individual.
+static int check_replay(const bench_args_t *args)
+{
+    float replay_best[2];
+    for (int run = 0; run < 2; run++) {
+        replay_best[run] = evolve_best(args->seed, replay_generations(args));
+    }
+    if (replay_best[0] != replay_best[1]) {
+        printf("replay MISMATCH: %.6f vs %.6f\n", replay_best[0], replay_best[1]);
+        return 1;
+    }
+    printf("%-20s %12s\n", "replay", "ok");
+
+    ga_mutation_stats_t mstats;
+    ga_get_mutation_stats(&mstats);
+    printf("%-20s %12.5f sigma, %.2f success rate, %u updates (%s)\n", "mutation", mstats.sigma,
+           mstats.success_rate, (unsigned)mstats.sigma_updates, g_adaptive_mutation ? "adaptive" : "fixed");
+    return 0;
+}
+
+// Gene codes must survive a round trip through float, the ESP-NOW
+// push relies on it, and a float gene moves by at most half a step.
+static int check_gene_codes(void)
+{
+    float gene_error = 0.0f;
+    for (int code = -GA_GENE_QMAX; code <= GA_GENE_QMAX; code++) {
+        float value = ga_gene_dequantise((int16_t)code);
+        if (ga_gene_quantise(value) != code) {
+            printf("gene code MISMATCH: %d -> %.6f -> %d\n", code, value, ga_gene_quantise(value));
+            return 1;
+        }
+        float nudged = value + (gene_max_value - gene_min_value) / (4.0f * GA_GENE_QMAX);
+        float err = fabsf(ga_gene_dequantise(ga_gene_quantise(nudged)) - nudged);
+        gene_error = err > gene_error ? err : gene_error;
+    }
+    // Population and its next generation buffer, as init_ga() allocates them
+    printf("%-20s %12u bytes, %u bit genes, %.6f max quantisation error\n", "population",
+           (unsigned)(2u * g_pop_size * MAX_GENES * sizeof(ga_gene_t)), (unsigned)(8 * sizeof(ga_gene_t)),
+           gene_error);
+    return 0;
+}
+
+// Parallel breeding splits the children over two RNG streams, which
+// must give the same run with or without the helper thread. Then time
+// both modes; the sweep shows where the barrier starts to pay off.
+static int check_parallel(const bench_args_t *args)
+{
+    float replay_best[2];
+    g_parallel_evolve = true;
+    for (int run = 0; run < 2; run++) {
+        if (run == 1 && ga_parallel_start() != ESP_OK) {
+            printf("parallel helper failed to start\n");
+            g_parallel_evolve = false;
+            return 1;
+        }
+        replay_best[run] = evolve_best(args->seed, replay_generations(args));
+    }
+    if (replay_best[0] != replay_best[1]) {
+        printf("parallel replay MISMATCH: %.6f vs %.6f\n", replay_best[0], replay_best[1]);
+        g_parallel_evolve = false;
+        return 1;
+    }
+    printf("%-20s %12s\n", "replay/parallel", "ok");
+
+    double mode_ns[2];
+    for (int par = 0; par < 2; par++) {
+        g_parallel_evolve = par;
+        reset_ga(args->seed);
+        double t0 = now_ns();
+        for (int i = 0; i < args->generations; i++) {
+            evolve();
+        }
+        mode_ns[par] = now_ns() - t0;
+        report(par ? "evolve/parallel" : "evolve/serial", mode_ns[par], args->generations);
+    }
+    printf("%-20s %12.2fx on %d workers, %ld cpus\n", "speedup/parallel", mode_ns[0] / mode_ns[1],
+           GA_PARALLEL_WORKERS, sysconf(_SC_NPROCESSORS_ONLN));
+    g_parallel_evolve = false;
+    return 0;
+}
+
+// Islands: each island breeds whole from its own stream, so a split
+// population must give the same run serial or on both cores (one
+// island splits its children instead, see check_parallel()). Then count
+// generations and time to ISLAND_TARGET over a few seeds.
+static int check_islands(const bench_args_t *args)
+{
+    static const int island_counts[] = { 1, 2, 4 };
+    int failed = 0;
+    char label[32];
+    for (size_t c = 0; c < sizeof(island_counts) / sizeof(island_counts[0]); c++) {
+        int islands = island_counts[c];
+        if (args->pop / islands < GA_MIN_ISLAND_SIZE) {
+            continue;
+        }
+        g_num_islands = islands;
+
+        float replay_best[2];
+        for (int par = 0; par < 2 && islands > 1; par++) {
+            g_parallel_evolve = par;
+            replay_best[par] = evolve_best(args->seed, replay_generations(args));
+        }
+        if (islands > 1 && replay_best[0] != replay_best[1]) {
+            printf("island replay MISMATCH (%d islands): %.6f vs %.6f\n", islands, replay_best[0], replay_best[1]);
+            failed++;
+            continue;
+        }
+
+        int hits = 0;
+        long hit_generations = 0;
+        double hit_ns = 0.0;
+        double final_best = 0.0;
+        for (int s = 0; s < ISLAND_SEEDS; s++) {
+            reset_ga(args->seed + (uint32_t)s);
+            bool hit = false;
+            double t0 = now_ns();
+            for (int i = 1; i <= args->generations; i++) {
+                evolve();
+                if (!hit && ga_get_local_best_fitness() <= ISLAND_TARGET) {
+                    hit = true;
+                    hits++;
+                    hit_generations += i;
+                    hit_ns += now_ns() - t0;
+                }
+            }
+            final_best += ga_get_local_best_fitness();
+        }
+        snprintf(label, sizeof(label), "islands/%d", islands);
+        printf("%-20s %12.3f mean best, %d/%d seeds reach %.1f in %.0f generations / %.2f ms, %u ring migrations\n",
+               label, final_best / ISLAND_SEEDS, hits, ISLAND_SEEDS, ISLAND_TARGET,
+               hits ? (double)hit_generations / hits : 0.0, hits ? hit_ns / hits / 1e6 : 0.0,
+               (unsigned)ga_get_ring_migrations());
+    }
+    g_num_islands = DEFAULT_NUM_ISLANDS;
+    g_parallel_evolve = false;
+    return failed;
+}
+
+// Every registered benchmark function through the same GA, to see the
+// cost of the registry dispatch and how far each gets.
+static void bench_fitness_functions(const bench_args_t *args)
+{
+    char label[32];
+    for (int id = 0; id < GA_FITNESS_COUNT; id++) {
+        g_fitness_function = id;
+        reset_ga(args->seed);
+        double t0 = now_ns();
+        for (int i = 0; i < args->generations; i++) {
+            evolve();
+        }
+        double fn_ns = now_ns() - t0;
+        snprintf(label, sizeof(label), "fn/%s", ga_fitness_lookup(id)->name);
+        printf("%-20s %12.1f ns/generation, best %.3f\n", label, fn_ns / args->generations,
+               ga_get_local_best_fitness());
+    }
+    g_fitness_function = GA_FITNESS_RASTRIGIN;
+}
+
+// Every optimiser engine on the same problem. Two islands must replay
+// serial or on both cores like the GA does, then time a single island.
+static int check_engines(const bench_args_t *args)
+{
+    int failed = 0;
+    char label[32];
+    for (int engine = 0; engine < GA_ENGINE_COUNT; engine++) {
+        g_ga_engine = engine;
+        g_num_islands = 2;
+        float replay_best[2];
+        for (int par = 0; par < 2 && args->pop / 2 >= GA_MIN_ISLAND_SIZE; par++) {
+            g_parallel_evolve = par;
+            replay_best[par] = evolve_best(args->seed, replay_generations(args));
+        }
+        if (args->pop / 2 >= GA_MIN_ISLAND_SIZE && replay_best[0] != replay_best[1]) {
+            printf("engine replay MISMATCH (%s): %.6f vs %.6f\n", ga_engine_name(engine), replay_best[0], replay_best[1]);
+            failed++;
+        }
+        g_num_islands = DEFAULT_NUM_ISLANDS;
+        g_parallel_evolve = false;
+
+        reset_ga(args->seed);
+        double t0 = now_ns();
+        for (int i = 0; i < args->generations; i++) {
+            evolve();
+        }
+        double engine_ns = now_ns() - t0;
+        ga_fitness_stats_t engine_stats;
+        ga_get_fitness_stats(&engine_stats);
+        snprintf(label, sizeof(label), "engine/%s", ga_engine_name(engine));
+        printf("%-20s %12.1f ns/generation, best %.3f, %u evaluations\n", label, engine_ns / args->generations,
+               ga_get_local_best_fitness(), (unsigned)engine_stats.evaluated);
+    }
+    g_ga_engine = GA_DEFAULT_ENGINE;
+    return failed;
+}
+
+// Memetic local search against plain evolution: best reached, and the
+// gain per millisecond of the search compared with the rest of evolve().
+static void bench_local_search(const bench_args_t *args)
+{
+    static const ga_local_search_mode_t ls_modes[] = {
+        GA_LOCAL_SEARCH_OFF, GA_LOCAL_SEARCH_EVERY_GENERATION, GA_LOCAL_SEARCH_ON_STALL };
+    static const char *ls_names[] = { "off", "every", "stall" };
+    char label[32];
+    for (size_t m = 0; m < sizeof(ls_modes) / sizeof(ls_modes[0]); m++) {
+        g_local_search = ls_modes[m];
+        reset_ga(args->seed);
+        float start_best = ga_get_local_best_fitness();
+        double t0 = now_ns();
+        for (int i = 0; i < args->generations; i++) {
+            evolve();
+        }
+        double ls_total_ms = (now_ns() - t0) / 1e6;
+        ga_local_search_stats_t ls;
+        ga_get_local_search_stats(&ls);
+        double ls_ms = ls.time_us / 1e3;
+        double evolve_gain = (start_best - ga_get_local_best_fitness()) - ls.best_gain;
+        snprintf(label, sizeof(label), "local/%s", ls_names[m]);
+        printf("%-20s %12.3f best in %.2f ms; search %u evals, %u improved, %.3f best gain in %.2f ms "
+               "(%.3f/ms vs %.3f/ms evolving)\n",
+               label, ga_get_local_best_fitness(), ls_total_ms, (unsigned)ls.evaluations,
+               (unsigned)ls.improvements, ls.best_gain, ls_ms, ls_ms > 0 ? ls.best_gain / ls_ms : 0.0,
+               evolve_gain / (ls_total_ms - ls_ms));
+    }
+    g_local_search = GA_LOCAL_SEARCH;
+}
+
+// Incremental diversity against a full recompute, across children,
+// ring migration, mass extinction and radio migrants. A migrant
+// republishes, so the snapshot then describes the current rows:
+// compare straight after the extinction and at the end.
+static int check_diversity(const bench_args_t *args)
+{
+    g_num_islands = (args->pop / 2 >= GA_MIN_ISLAND_SIZE) ? 2 : 1;
+    reset_ga(args->seed);
+    float start_diversity = ga_get_diversity();
+    float tracked[2], measured[2];
+    ga_best_snapshot_t div_snap;
+    for (int i = 1; i <= args->generations; i++) {
+        evolve();
+        if (i == args->generations / 2 || i == args->generations) {
+            int at = (i == args->generations);
+            if (!at) {
+                activate_hyper_mutation();
+            }
+            ga_get_best_snapshot(&div_snap);
+            ga_integrate_remote_solution(div_snap.genes);
+            tracked[at] = ga_get_diversity();
+            measured[at] = ga_measure_diversity();
+        }
+    }
+    printf("%-20s %12.5f at start, %.5f tracked vs %.5f measured after extinction, %.6f vs %.6f at end\n",
+           "diversity", start_diversity, tracked[0], measured[0], tracked[1], measured[1]);
+    g_num_islands = DEFAULT_NUM_ISLANDS;
+    for (int at = 0; at < 2; at++) {
+        if (fabsf(tracked[at] - measured[at]) > 1e-3f * measured[at] + 1e-5f) {
+            printf("diversity MISMATCH\n");
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Checkpoint round trip: every engine restored from a checkpoint must
+// carry on exactly as the GA it was taken from. Then the boot path:
+// init_ga() with g_ga_resume picks up the stored one, whatever g_pop_size.
+// Two islands where the population allows, so their layout is restored too.
+static int check_checkpoint(const bench_args_t *args)
+{
+    g_num_islands = (args->pop / 2 >= GA_MIN_ISLAND_SIZE) ? 2 : 1;
+    size_t ckpt_bytes = 0;
+    double encode_ns = 0.0, restore_ns = 0.0;
+    int failed = 0;
+    for (int engine = 0; engine < GA_ENGINE_COUNT; engine++) {
+        g_ga_engine = engine;
+        evolve_best(args->seed, replay_generations(args));
+        ckpt_bytes = ga_checkpoint_size();
+        void *ckpt = malloc(ckpt_bytes);
+        double t0 = now_ns();
+        if (ckpt == NULL || ga_checkpoint_encode(ckpt, ckpt_bytes) != ckpt_bytes) {
+            printf("checkpoint encode FAILED (%s)\n", ga_engine_name(engine));
+            free(ckpt);
+            failed++;
+            continue;
+        }
+        encode_ns += now_ns() - t0;
+
+        ga_best_snapshot_t ckpt_snap[2];
+        bool restored = true;
+        for (int run = 0; run < 2 && restored; run++) {
+            if (run == 1) {
+                t0 = now_ns();
+                restored = ga_checkpoint_restore(ckpt, ckpt_bytes) == ESP_OK;
+                restore_ns += now_ns() - t0;
+            }
+            for (int i = 0; i < replay_generations(args); i++) {
+                evolve();
+            }
+            ga_get_best_snapshot(&ckpt_snap[run]);
+        }
+        free(ckpt);
+        if (!restored) {
+            printf("checkpoint restore FAILED (%s)\n", ga_engine_name(engine));
+            failed++;
+        } else if (ckpt_snap[0].fitness != ckpt_snap[1].fitness ||
+                   ckpt_snap[0].generation != ckpt_snap[1].generation ||
+                   memcmp(ckpt_snap[0].genes, ckpt_snap[1].genes, sizeof(ckpt_snap[0].genes)) != 0) {
+            printf("checkpoint replay MISMATCH (%s): %.6f vs %.6f\n", ga_engine_name(engine),
+                   ckpt_snap[0].fitness, ckpt_snap[1].fitness);
+            failed++;
+        }
+    }
+    g_ga_engine = GA_DEFAULT_ENGINE;
+
+    ga_best_snapshot_t before_boot;
+    ga_get_best_snapshot(&before_boot);
+    if (ga_checkpoint_save() != ESP_OK) {
+        printf("checkpoint save FAILED\n");
+        g_num_islands = DEFAULT_NUM_ISLANDS;
+        return failed + 1;
+    }
+    g_ga_resume = true;
+    g_pop_size = args->pop + 2;
+    g_num_islands = DEFAULT_NUM_ISLANDS;
+    double t0 = now_ns();
+    init_ga(false);
+    double resume_ns = now_ns() - t0;
+    g_ga_resume = false;
+    g_pop_size = args->pop;
+    g_num_islands = DEFAULT_NUM_ISLANDS;
+    if (ga_population_size() != args->pop || ga_resumed_generation != before_boot.generation ||
+        ga_get_local_best_fitness() != before_boot.fitness) {
+        printf("checkpoint resume MISMATCH: pop %d, generation %u\n", ga_population_size(),
+               (unsigned)ga_resumed_generation);
+        return failed + 1;
+    }
+    printf("%-20s %12u bytes, encode %.1f us, restore %.1f us, boot resume %.1f us\n", "checkpoint",
+           (unsigned)ckpt_bytes, encode_ns / GA_ENGINE_COUNT / 1e3, restore_ns / GA_ENGINE_COUNT / 1e3,
+           resume_ns / 1e3);
+    return failed;
+}
+
+// Snapshot readers run on another thread against a live evolve() loop
+// and must never see a half-published best.
+static int check_snapshot(const bench_args_t *args)
+{
+    snapshot_reader_t reader = { 0 };
+    reset_ga(args->seed);
+    xTaskCreate(snapshot_reader_task, "snap", 4096, &reader, 1, NULL);
+    double t0 = now_ns();
+    for (int i = 0; i < args->generations; i++) {
+        evolve();
+    }
+    reader.stop = true;
+    while (!reader.done) {
+        vTaskDelay(1);
+    }
+    double snap_ns = now_ns() - t0;
+    printf("%-20s %12.1f ns/read, %u reads, %u torn\n", "snapshot", snap_ns / (reader.reads ? reader.reads : 1),
+           (unsigned)reader.reads, (unsigned)reader.torn);
+    return (reader.torn || reader.backwards) ? 1 : 0;
+}
+
+// Persistent worker: each hyper-mutation restart is a queued command
+// rather than a task create/delete, report how long it takes to start.
+static int check_worker(const bench_args_t *args)
+{
+    if (args->worker_runs <= 0) {
+        return 0;
+    }
+    reset_ga(args->seed);
+    host_ga_logging_start();
+    ga_event_group = xEventGroupCreate();
+    if (ga_worker_start() != ESP_OK) {
+        printf("GA worker failed to start\n");
+        return 1;
+    }
+    ga_request_run();
+    xEventGroupWaitBits(ga_event_group, GA_COMPLETED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    for (int i = 1; i < args->worker_runs; i++) {
+        ga_request_hyper_mutation();
+        xEventGroupWaitBits(ga_event_group, GA_COMPLETED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    ga_request_stop();
+    xEventGroupWaitBits(ga_event_group, GA_STOPPED_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+
+    ga_worker_stats_t stats;
+    ga_get_worker_stats(&stats);
+    printf("%-20s %12u runs, restart mean %.1f us, max %u us\n", "worker", (unsigned)stats.runs,
+           stats.runs ? (double)stats.total_restart_us / stats.runs : 0.0, (unsigned)stats.max_restart_us);
+    return (int)stats.runs != args->worker_runs;
+}
+
+#if GA_PROFILE
+// Per-phase cycles since the last init_ga(), worker runs included. On
+// the host a cycle is a nanosecond of CLOCK_MONOTONIC.
+static int check_profile(void)
+{
+    ga_phase_stats_t phases[GA_PHASE_COUNT];
+    char label[32];
+    ga_get_phase_stats(phases);
+    uint64_t evolve_cycles = 0;
+    for (int p = GA_PHASE_FITNESS; p <= GA_PHASE_COPY_BACK; p++) {
+        evolve_cycles += phases[p].total_cycles;
+    }
+    for (int p = 0; p < GA_PHASE_COUNT; p++) {
+        snprintf(label, sizeof(label), "phase/%s", ga_phase_name(p));
+        printf("%-20s %12.0f mean cycles, min %u, max %u, %u samples, %.1f%% of evolve\n", label,
+               phases[p].count ? (double)phases[p].total_cycles / phases[p].count : 0.0,
+               (unsigned)phases[p].min_cycles, (unsigned)phases[p].max_cycles, (unsigned)phases[p].count,
+               evolve_cycles ? 100.0 * phases[p].total_cycles / evolve_cycles : 0.0);
+    }
+    return (phases[GA_PHASE_FITNESS].count == 0 || phases[GA_PHASE_BREED].count == 0) ? 1 : 0;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    bench_args_t args;
+    parse_args(argc, argv, &args);
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    g_pop_size = args.pop;
+    printf("GA bench POP_SIZE=%d MAX_GENES=%d seed=%u iterations=%d generations=%d\n",
+           args.pop, MAX_GENES, (unsigned)args.seed, args.iterations, args.generations);
+
+    int failed = 0;
+    bench_stages(&args);
+    bench_selection(&args);
+    failed += check_replay(&args);
+    failed += check_gene_codes();
+    failed += check_parallel(&args);
+    failed += check_islands(&args);
+    bench_fitness_functions(&args);
+    failed += check_engines(&args);
+    bench_local_search(&args);
+    failed += check_diversity(&args);
+    failed += check_checkpoint(&args);
+    failed += check_snapshot(&args);
+    failed += check_worker(&args);
+#if GA_PROFILE
+    failed += check_profile();
+#endif
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,274 @@
+/* Time-to-target convergence suite for GA configurations.
+ *
+ * Runs the real evolve() from many seeds and records, for each fitness
+ * threshold, the generation and process CPU time at which the best first
+ * reached it. Runs follow the firmware cycle: evolve until the ga_task
+ * stagnation rule (DEFAULT_PATIENCE) fires, then mass extinction plus
+ * hyper-mutation as check_hyper_mutation() would request, and evolve
+ * again, up to --max-generations in total.
+ *
+ * The tuning macros (PERCENT_CHILD, XOVER_PROB, MUTATE_WIDTH,
+ * DEFAULT_PATIENCE, MASS_EXTINCTION_PERCENT) are compile time, so each
+ * configuration in GA_CONVERGENCE_CONFIGS is its own ga_converge_<name>
+ * binary. The ga_convergence_suite target runs them all into one CSV,
+ * one row per configuration and threshold, to diff between firmware
+ * versions. Generations and times are -1 where fewer seeds than the
+ * percentile needs reached the threshold.
+ *
+ * The optimiser engine (GA_DEFAULT_ENGINE) is one of those macros, so
+ * engines compare on the same rows: CPU time per threshold, and the radio
+ * bytes the swarm would have spent getting there, one migration push
+ * (PUSH_BYTES) per stagnation.
+ *
+ * --max-mean-best F fails the run (exit 1) if the mean final best of the
+ * seeds is above F, so ctest can bound how much a configuration such as
+ * quant16 (GA_QUANTISED_GENES) may cost in solution quality.
+ *
+ * Usage: ga_converge_<name> [--seeds N] [--max-generations N] [--pop N]
+ *                           [--thresholds T1,T2,...] [--seed S] [--out FILE]
+ *                           [--max-mean-best F]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_log.h"
+#include "esp_random.h"
+#include "globals.h"
+#include "ga.h"
+#include "data_structures.h"
+#include "ga_fitness.h"
+#include "ga_host.h"
+#include "bench_util.h"
+
+#ifndef GA_CONFIG_NAME
+#define GA_CONFIG_NAME "default"
+#endif
+#ifndef GA_FIRMWARE_VERSION
+#define GA_FIRMWARE_VERSION "unknown"
+#endif
+
+#define DEFAULT_SEEDS           30
+#define DEFAULT_MAX_GENERATIONS 3000
+#define DEFAULT_FIRST_SEED      1u
+#define MAX_THRESHOLDS          8
+
+// One migration push as espnow_push_best_solution() sends it: a
+// migration frame unicast to half of the other robots, at least one.
+#define PUSH_TARGETS ((DEFAULT_NUM_ROBOTS - 1) / 2 > 0 ? (DEFAULT_NUM_ROBOTS - 1) / 2 : 1)
+#define PUSH_BYTES   ((int)MIGRATION_FRAME_SIZE(MAX_GENES, GA_QUANTISED_GENES) * PUSH_TARGETS)
+
+typedef struct {
+    int seeds;
+    int max_generations;
+    int pop;
+    uint32_t first_seed;
+    float thresholds[MAX_THRESHOLDS];   // descending, easiest first
+    int threshold_count;
+    const char *out;
+    float max_mean_best;                // 0 = no bound
+} suite_args_t;
+
+static double cpu_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_float_desc(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+    return (x < y) - (x > y);
+}
+
+// Nearest-rank percentile of the n samples, missed seeds count as
+// infinitely slow. -1 if the rank falls on a miss.
+static double percentile(double *samples, int hits, int n, double p)
+{
+    int rank = (int)(p * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > hits) {
+        return -1.0;
+    }
+    qsort(samples, hits, sizeof(double), compare_double);
+    return samples[rank - 1];
+}
+
+static void parse_thresholds(const char *list, suite_args_t *args)
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s", list);
+    args->threshold_count = 0;
+    for (char *tok = strtok(buf, ","); tok != NULL && args->threshold_count < MAX_THRESHOLDS;
+         tok = strtok(NULL, ",")) {
+        args->thresholds[args->threshold_count++] = strtof(tok, NULL);
+    }
+    qsort(args->thresholds, args->threshold_count, sizeof(float), compare_float_desc);
+}
+
+static void parse_args(int argc, char **argv, suite_args_t *args)
+{
+    args->seeds = DEFAULT_SEEDS;
+    args->max_generations = DEFAULT_MAX_GENERATIONS;
+    args->pop = POP_SIZE;
+    args->first_seed = DEFAULT_FIRST_SEED;
+    args->out = NULL;
+    args->max_mean_best = 0.0f;
+    parse_thresholds("40,30,25,20", args);
+
+    for (int i = 1; i < argc; i++) {
+        if (bench_common_arg(argc, argv, &i, NULL, &args->first_seed)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--seeds") && i + 1 < argc) {
+            args->seeds = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--max-generations") && i + 1 < argc) {
+            args->max_generations = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--pop") && i + 1 < argc) {
+            args->pop = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--thresholds") && i + 1 < argc) {
+            parse_thresholds(argv[++i], args);
+        } else if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+            args->out = argv[++i];
+        } else if (!strcmp(argv[i], "--max-mean-best") && i + 1 < argc) {
+            args->max_mean_best = strtof(argv[++i], NULL);
+        } else {
+            fprintf(stderr, "usage: %s [--seeds N] [--max-generations N] [--pop N] "
+                            "[--thresholds T1,T2,...] [--seed S] [--out FILE]\n"
+                            "       [--max-mean-best F]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (args->seeds < 1) args->seeds = 1;
+    if (args->max_generations < 1) args->max_generations = 1;
+    if (args->threshold_count < 1) parse_thresholds("10", args);
+}
+
+// One seed, firmware cycle. Fills gen[t]/ms[t]/bytes[t] for every
+// threshold reached, returns the best fitness at the end.
+static float run_seed(const suite_args_t *args, uint32_t seed, int *gen, double *ms, double *bytes)
+{
+    host_esp_random_seed(seed);
+    if (init_ga(false) != ESP_OK) {
+        fprintf(stderr, "init_ga failed for --pop %d\n", g_pop_size);
+        exit(1);
+    }
+
+    for (int t = 0; t < args->threshold_count; t++) {
+        gen[t] = -1;
+        ms[t] = -1.0;
+        bytes[t] = -1.0;
+    }
+
+    ga_stagnation_t stagnation;
+    ga_stagnation_reset(&stagnation, DEFAULT_PATIENCE);
+    int next = 0;   // easiest threshold not reached yet
+    int pushes = 0;
+    double t0 = cpu_ms();
+
+    for (int g = 1; g <= args->max_generations && next < args->threshold_count; g++) {
+        evolve();
+        float best = ga_get_local_best_fitness();
+        while (next < args->threshold_count && best <= args->thresholds[next]) {
+            gen[next] = g;
+            ms[next] = cpu_ms() - t0;
+            bytes[next] = (double)pushes * PUSH_BYTES;
+            next++;
+        }
+
+        ga_stagnation_update(&stagnation, best);
+        if (ga_stagnated(&stagnation)) {
+            pushes++;   // ga_run() ends here and pushes its best
+            activate_hyper_mutation();
+            ga_stagnation_reset(&stagnation, DEFAULT_PATIENCE);
+        }
+    }
+    return ga_get_local_best_fitness();
+}
+
+int main(int argc, char **argv)
+{
+    suite_args_t args;
+    parse_args(argc, argv, &args);
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    g_pop_size = args.pop;
+
+    int tc = args.threshold_count;
+    int *hits = calloc(tc, sizeof(int));
+    double *gens = malloc(sizeof(double) * tc * args.seeds);
+    double *times = malloc(sizeof(double) * tc * args.seeds);
+    double *radio = malloc(sizeof(double) * tc * args.seeds);
+    int gen[MAX_THRESHOLDS];
+    double ms[MAX_THRESHOLDS];
+    double bytes[MAX_THRESHOLDS];
+    double final_best = 0.0;
+    if (hits == NULL || gens == NULL || times == NULL || radio == NULL) {
+        return 1;
+    }
+
+    for (int s = 0; s < args.seeds; s++) {
+        final_best += run_seed(&args, args.first_seed + (uint32_t)s, gen, ms, bytes);
+        for (int t = 0; t < tc; t++) {
+            if (gen[t] >= 0) {
+                gens[t * args.seeds + hits[t]] = gen[t];
+                times[t * args.seeds + hits[t]] = ms[t];
+                radio[t * args.seeds + hits[t]] = bytes[t];
+                hits[t]++;
+            }
+        }
+    }
+
+    FILE *out = stdout;
+    if (args.out != NULL) {
+        out = fopen(args.out, "a");
+        if (out == NULL) {
+            perror(args.out);
+            return 1;
+        }
+    }
+    // Header only at the top of a new table
+    if (out == stdout || ftell(out) == 0) {
+        fprintf(out, "version,config,engine,function,pop_size,max_genes,percent_child,xover_prob,mutate_width,"
+                     "patience,mass_extinction,seeds,max_generations,threshold,hits,"
+                     "gen_median,gen_p95,cpu_ms_median,cpu_ms_p95,radio_bytes_median,radio_bytes_p95,"
+                     "mean_final_best\n");
+    }
+    for (int t = 0; t < tc; t++) {
+        double *g = gens + t * args.seeds;
+        double *c = times + t * args.seeds;
+        double *r = radio + t * args.seeds;
+        fprintf(out, "%s,%s,%s,%s,%d,%d,%.3f,%.3f,%.4f,%d,%d,%d,%d,%.3f,%d,%.0f,%.0f,%.3f,%.3f,%.0f,%.0f,%.3f\n",
+                GA_FIRMWARE_VERSION, GA_CONFIG_NAME, ga_engine, fitness_function, g_pop_size, MAX_GENES,
+                (double)PERCENT_CHILD, (double)XOVER_PROB, (double)MUTATE_WIDTH, DEFAULT_PATIENCE,
+                DEFAULT_MASS_EXTINCTION, args.seeds, args.max_generations, (double)args.thresholds[t],
+                hits[t], percentile(g, hits[t], args.seeds, 0.5), percentile(g, hits[t], args.seeds, 0.95),
+                percentile(c, hits[t], args.seeds, 0.5), percentile(c, hits[t], args.seeds, 0.95),
+                percentile(r, hits[t], args.seeds, 0.5), percentile(r, hits[t], args.seeds, 0.95),
+                final_best / args.seeds);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    free(hits);
+    free(gens);
+    free(times);
+    free(radio);
+
+    if (args.max_mean_best > 0.0f && final_best / args.seeds > args.max_mean_best) {
+        fprintf(stderr, "%s: mean final best %.3f is above the %.3f bound\n",
+                GA_CONFIG_NAME, final_best / args.seeds, (double)args.max_mean_best);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+/* Fitness kernel benchmark and accuracy check for the host build.
+ *
+ * Compares the single precision kernels in ga_fitness.h against the
+ * original double precision pow()/cos() Rastrigin, then times every
+ * registered benchmark function and checks it against a double precision
+ * evaluation within its bounds. The host has a double FPU, so the speedup
+ * printed here understates the one on the ESP32 where the reference runs
+ * in soft-float.
+ *
+ * Exits non-zero if ga_cos2pi() exceeds GA_COS2PI_MAX_ABS_ERROR or a
+ * kernel exceeds GA_KERNEL_MAX_REL_ERROR.
+ *
+ * Usage: ga_fitness_bench [--genomes N] [--rounds N]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "globals.h"
+#include "Arduino.h"
+#include "ga_fitness.h"
+#include "bench_util.h"
+
+#define COS_SWEEP_STEPS 2000000
+
+// The Rastrigin evaluation ga.c used before the float kernel.
+static float rastrigin_reference(const float *genes)
+{
+    float f_sum = 0.0;
+    for (int gene = 0; gene < MAX_GENES; gene++) {
+        float geneValue = genes[gene];
+        float p0 = pow(geneValue, 2);
+        float p1 = A * cos(TWO_PI * geneValue);
+        f_sum += (p0 - p1);
+    }
+    return A * MAX_GENES + f_sum;
+}
+
+// Double precision versions of the registered functions, same formulas
+static double reference(int id, const float *g)
+{
+    double sum = 0.0, aux = 0.0;
+    switch (id) {
+    case GA_FITNESS_RASTRIGIN:
+        for (int i = 0; i < MAX_GENES; i++) sum += (double)g[i] * g[i] - A * cos(2.0 * M_PI * g[i]);
+        return A * MAX_GENES + sum;
+    case GA_FITNESS_SPHERE:
+        for (int i = 0; i < MAX_GENES; i++) sum += (double)g[i] * g[i];
+        return sum;
+    case GA_FITNESS_ROSENBROCK:
+        for (int i = 0; i < MAX_GENES - 1; i++) {
+            double valley = (double)g[i + 1] - (double)g[i] * g[i];
+            sum += 100.0 * valley * valley + (1.0 - g[i]) * (1.0 - g[i]);
+        }
+        return sum;
+    case GA_FITNESS_ACKLEY:
+        for (int i = 0; i < MAX_GENES; i++) {
+            sum += (double)g[i] * g[i];
+            aux += cos(2.0 * M_PI * g[i]);
+        }
+        return -20.0 * exp(-0.2 * sqrt(sum / MAX_GENES)) - exp(aux / MAX_GENES) + 20.0 + M_E;
+    case GA_FITNESS_SCHWEFEL:
+        for (int i = 0; i < MAX_GENES; i++) sum += g[i] * sin(sqrt(fabs((double)g[i])));
+        return 418.98288727 * MAX_GENES - sum;
+    case GA_FITNESS_GRIEWANK:
+        aux = 1.0;
+        for (int i = 0; i < MAX_GENES; i++) {
+            sum += (double)g[i] * g[i];
+            aux *= cos(g[i] / sqrt(i + 1.0));
+        }
+        return 1.0 + sum / 4000.0 - aux;
+    default:
+        return 0.0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int genomes = 4096;
+    int rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--genomes") && i + 1 < argc) {
+            genomes = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--rounds") && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--genomes N] [--rounds N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (genomes < 1) genomes = 1;
+    if (rounds < 1) rounds = 1;
+
+    // Accuracy of the cosine over the whole gene range
+    double max_cos_err = 0.0;
+    double worst_x = 0.0;
+    for (int i = 0; i <= COS_SWEEP_STEPS; i++) {
+        float x = (float)(-5.12 + 10.24 * i / COS_SWEEP_STEPS);
+        double err = fabs((double)ga_cos2pi(x) - cos(2.0 * M_PI * (double)x));
+        if (err > max_cos_err) {
+            max_cos_err = err;
+            worst_x = x;
+        }
+    }
+
+    float *genes = malloc(sizeof(float) * MAX_GENES * genomes);
+    if (genes == NULL) {
+        return 1;
+    }
+    srand(1);
+    for (int i = 0; i < MAX_GENES * genomes; i++) {
+        genes[i] = (float)(-5.12 + 10.24 * rand() / (double)RAND_MAX);
+    }
+
+    // Accuracy of the full fitness against a double precision evaluation
+    double max_fit_err = 0.0;
+    for (int n = 0; n < genomes; n++) {
+        const float *g = genes + n * MAX_GENES;
+        double exact = A * MAX_GENES;
+        for (int gene = 0; gene < MAX_GENES; gene++) {
+            exact += (double)g[gene] * g[gene] - A * cos(2.0 * M_PI * (double)g[gene]);
+        }
+        double err = fabs((double)ga_rastrigin(g) - exact);
+        if (err > max_fit_err) max_fit_err = err;
+    }
+
+    float acc = 0.0f;
+    double t0 = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int n = 0; n < genomes; n++) {
+            acc += rastrigin_reference(genes + n * MAX_GENES);
+        }
+    }
+    double ref_ns = (now_ns() - t0) / ((double)rounds * genomes);
+
+    t0 = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int n = 0; n < genomes; n++) {
+            acc += ga_rastrigin(genes + n * MAX_GENES);
+        }
+    }
+    double fast_ns = (now_ns() - t0) / ((double)rounds * genomes);
+
+    printf("GA fitness bench MAX_GENES=%d genomes=%d rounds=%d\n", MAX_GENES, genomes, rounds);
+    printf("%-26s %12.1f ns/genome\n", "rastrigin double libm", ref_ns);
+    printf("%-26s %12.1f ns/genome\n", "rastrigin float kernel", fast_ns);
+    printf("%-26s %12.2fx\n", "speedup", ref_ns / fast_ns);
+    printf("%-26s %12.3g (at x=%.6f, bound %.1g)\n", "cos2pi max abs error", max_cos_err, worst_x,
+           (double)GA_COS2PI_MAX_ABS_ERROR);
+    printf("%-26s %12.3g\n", "rastrigin max abs error", max_fit_err);
+    int failed = max_cos_err > GA_COS2PI_MAX_ABS_ERROR;
+
+    // Every registered function, with genomes drawn over its own bounds.
+    // Timed through the registry pointer, the way ga.c calls it.
+    char label[32];
+    for (int id = 0; id < GA_FITNESS_COUNT; id++) {
+        const ga_fitness_function_t *fn = ga_fitness_lookup(id);
+        for (int i = 0; i < MAX_GENES * genomes; i++) {
+            genes[i] = fn->min_gene + (fn->max_gene - fn->min_gene) * (float)rand() / (float)RAND_MAX;
+        }
+
+        double max_rel_err = 0.0;
+        for (int n = 0; n < genomes; n++) {
+            const float *g = genes + n * MAX_GENES;
+            double exact = reference(id, g);
+            double err = fabs((double)fn->kernel(g) - exact) / (1.0 + fabs(exact));
+            if (err > max_rel_err) max_rel_err = err;
+        }
+
+        t0 = now_ns();
+        for (int r = 0; r < rounds; r++) {
+            for (int n = 0; n < genomes; n++) {
+                acc += fn->kernel(genes + n * MAX_GENES);
+            }
+        }
+        double fn_ns = (now_ns() - t0) / ((double)rounds * genomes);
+
+        snprintf(label, sizeof(label), "%s", fn->name);
+        printf("%-26s %12.1f ns/genome, max rel error %.3g, domain [%g, %g]\n", label, fn_ns, max_rel_err,
+               (double)fn->min_gene, (double)fn->max_gene);
+        if (max_rel_err > GA_KERNEL_MAX_REL_ERROR) {
+            failed = 1;
+        }
+    }
+    bench_sink(acc);
+    free(genes);
+
+    return failed;
+}
@@ -0,0 +1,338 @@
+/* Unicast against broadcast migration on a simulated ESP-NOW channel.
+ *
+ * Every robot shares one 802.11b channel at 1 Mbps, the ESP-NOW default
+ * rate, and all hear each other. A robot migrates at random, on average
+ * every --interval-ms. Under ROUTING_UNICAST (with the RANDOM topology) it
+ * queues one migration frame per peer. Each unicast frame is acknowledged
+ * and retried with a doubling contention window. Under ROUTING_BROADCAST
+ * it queues one frame for every peer, sent once with no ack or retry.
+ * Access is slotted CSMA/CA: stations count down a random backoff after
+ * DIFS, and two reaching zero together collide. Each receiver also loses
+ * a frame independently with probability --loss-pct, as does the
+ * sender's ack. A station holds at most --queue frames and esp_now_send()
+ * refuses the rest. Hidden terminals and capture are not modelled.
+ *
+ * Per swarm size it reports the channel time per migration, the
+ * transmissions and the share of (migration, peer) pairs delivered.
+ *
+ * Exits non-zero if a broadcast migration takes more than one
+ * transmission, broadcast uses more airtime per migration than unicast,
+ * or delivery strays from what the loss rate allows on a quiet channel.
+ *
+ * Usage: migration_airtime_bench [--genes N] [--seconds N] [--interval-ms N]
+ *                                [--loss-pct N] [--queue N] [--seed N]
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data_structures.h"
+#include "bench_util.h"
+
+// 802.11b long preamble at 1 Mbps, all in microseconds
+#define PHY_OVERHEAD_US  192
+#define US_PER_BYTE      8
+#define SLOT_US          20
+#define SIFS_US          10
+#define DIFS_US          50
+#define ACK_BYTES        14
+#define MAC_BYTES        (24 + 4)   // header and FCS
+#define ESPNOW_BYTES     15         // action frame category, vendor element
+#define CW_MIN           31
+#define CW_MAX           1023
+#define RETRY_LIMIT      7
+#define MAX_ROBOTS       64
+
+#define DEFAULT_GENES        10
+#define DEFAULT_SECONDS      30
+#define DEFAULT_INTERVAL_MS  1000
+#define DEFAULT_LOSS_PCT     5
+#define DEFAULT_QUEUE        32
+
+typedef struct {
+    int genes;
+    int seconds;
+    int interval_ms;
+    int loss_pct;
+    int queue;
+    uint32_t seed;
+} bench_args_t;
+
+typedef struct {
+    int dest;                   // peer, or -1 for a broadcast
+    int retries;
+    bool reached;               // by an earlier try whose ack was lost
+} tx_frame_t;
+
+typedef struct {
+    tx_frame_t *frames;         // ring of args.queue
+    int head, count;
+    int backoff;                // slots left, -1 to draw
+    int cw;
+    double next_migration_us;
+} station_t;
+
+typedef struct {
+    long migrations;
+    long transmissions;
+    long refused;               // by a full queue
+    long delivered;             // (migration, peer) pairs
+    double airtime_us;          // every transmission, colliding ones each
+    double busy_us;             // the channel, once for a collision
+    double elapsed_us;          // until the last queue drained
+} result_t;
+
+static uint64_t s_rng;
+
+static double uniform(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 7;
+    s_rng ^= s_rng << 17;
+    return (double)(s_rng >> 11) / 9007199254740992.0;
+}
+
+static void parse_args(int argc, char **argv, bench_args_t *args)
+{
+    args->genes = DEFAULT_GENES;
+    args->seconds = DEFAULT_SECONDS;
+    args->interval_ms = DEFAULT_INTERVAL_MS;
+    args->loss_pct = DEFAULT_LOSS_PCT;
+    args->queue = DEFAULT_QUEUE;
+    args->seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (bench_common_arg(argc, argv, &i, NULL, &args->seed)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--genes") && i + 1 < argc) {
+            args->genes = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            args->seconds = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--interval-ms") && i + 1 < argc) {
+            args->interval_ms = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--loss-pct") && i + 1 < argc) {
+            args->loss_pct = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--queue") && i + 1 < argc) {
+            args->queue = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--genes N] [--seconds N] [--interval-ms N] [--loss-pct N] "
+                            "[--queue N] [--seed N]\n", argv[0]);
+            exit(2);
+        }
+    }
+    if (args->genes < 1) args->genes = 1;
+    if (args->seconds < 1) args->seconds = 1;
+    if (args->interval_ms < 1) args->interval_ms = 1;
+    if (args->loss_pct < 0) args->loss_pct = 0;
+    if (args->loss_pct > 100) args->loss_pct = 100;
+    if (args->queue < 1) args->queue = 1;
+}
+
+static double next_interval_us(const bench_args_t *args)
+{
+    return -log(1.0 - uniform()) * args->interval_ms * 1000.0;
+}
+
+static bool received(const bench_args_t *args)
+{
+    return uniform() * 100.0 >= args->loss_pct;
+}
+
+static void enqueue(station_t *st, const bench_args_t *args, int dest, result_t *res)
+{
+    if (st->count == args->queue) {
+        res->refused++;
+        return;
+    }
+    st->frames[(st->head + st->count) % args->queue] = (tx_frame_t){ .dest = dest };
+    st->count++;
+}
+
+static void pop_frame(station_t *st, const bench_args_t *args)
+{
+    st->head = (st->head + 1) % args->queue;
+    st->count--;
+    st->cw = CW_MIN;
+    st->backoff = -1;
+}
+
+static void run(const bench_args_t *args, int robots, bool broadcast, result_t *res)
+{
+    static station_t stations[MAX_ROBOTS];
+    const int frame_bytes = MAC_BYTES + ESPNOW_BYTES + (int)MIGRATION_FRAME_SIZE(args->genes, 0);
+    const double data_us = PHY_OVERHEAD_US + frame_bytes * US_PER_BYTE;
+    const double ack_us = SIFS_US + PHY_OVERHEAD_US + ACK_BYTES * US_PER_BYTE;
+    const double end_us = args->seconds * 1e6;
+
+    memset(res, 0, sizeof(*res));
+    for (int i = 0; i < robots; i++) {
+        stations[i] = (station_t){
+            .frames = calloc(args->queue, sizeof(tx_frame_t)),
+            .backoff = -1,
+            .cw = CW_MIN,
+            .next_migration_us = next_interval_us(args),
+        };
+    }
+
+    double now = 0.0;
+    for (;;) {
+        // Migrations due by now, only while the run lasts
+        for (int i = 0; i < robots; i++) {
+            station_t *st = &stations[i];
+            while (st->next_migration_us <= now && st->next_migration_us < end_us) {
+                res->migrations++;
+                if (broadcast) {
+                    enqueue(st, args, -1, res);
+                } else {
+                    for (int peer = 0; peer < robots; peer++) {
+                        if (peer != i) {
+                            enqueue(st, args, peer, res);
+                        }
+                    }
+                }
+                st->next_migration_us += next_interval_us(args);
+            }
+        }
+
+        // Contention among the stations with something to send
+        int min_backoff = CW_MAX + 1;
+        for (int i = 0; i < robots; i++) {
+            station_t *st = &stations[i];
+            if (st->count > 0) {
+                if (st->backoff < 0) {
+                    st->backoff = (int)(uniform() * (st->cw + 1));
+                }
+                if (st->backoff < min_backoff) {
+                    min_backoff = st->backoff;
+                }
+            }
+        }
+        if (min_backoff > CW_MAX) {
+            // Idle channel: on to the next migration, or done
+            double next = end_us;
+            for (int i = 0; i < robots; i++) {
+                if (stations[i].next_migration_us < next) {
+                    next = stations[i].next_migration_us;
+                }
+            }
+            if (next >= end_us) {
+                break;
+            }
+            now = next;
+            continue;
+        }
+
+        int winners = 0, winner = -1;
+        for (int i = 0; i < robots; i++) {
+            station_t *st = &stations[i];
+            if (st->count > 0) {
+                st->backoff -= min_backoff;
+                if (st->backoff == 0) {
+                    winners++;
+                    winner = i;
+                }
+            }
+        }
+        now += DIFS_US + (double)min_backoff * SLOT_US;
+
+        // Unicast frames hold the channel through the ack or its timeout
+        double busy = data_us + (broadcast ? 0.0 : ack_us);
+        res->transmissions += winners;
+        res->airtime_us += busy * winners;
+        res->busy_us += busy;
+        now += busy;
+
+        for (int i = 0; i < robots; i++) {
+            station_t *st = &stations[i];
+            if (st->count == 0 || st->backoff != 0) {
+                continue;
+            }
+            tx_frame_t *frame = &st->frames[st->head];
+            if (frame->dest < 0) {
+                // Broadcast: gone whatever happened, to each peer that heard it
+                if (winners == 1) {
+                    for (int peer = 0; peer < robots; peer++) {
+                        res->delivered += peer != winner && received(args);
+                    }
+                }
+                pop_frame(st, args);
+            } else {
+                // Unicast: done once acked, retried until then
+                if (winners == 1 && received(args)) {
+                    frame->reached = true;
+                    if (received(args)) {
+                        res->delivered++;
+                        pop_frame(st, args);
+                        continue;
+                    }
+                }
+                if (++frame->retries > RETRY_LIMIT) {
+                    res->delivered += frame->reached;
+                    pop_frame(st, args);
+                } else {
+                    st->cw = st->cw * 2 + 1 > CW_MAX ? CW_MAX : st->cw * 2 + 1;
+                    st->backoff = -1;
+                }
+            }
+        }
+    }
+
+    res->elapsed_us = now > end_us ? now : end_us;
+    for (int i = 0; i < robots; i++) {
+        free(stations[i].frames);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench_args_t args;
+    parse_args(argc, argv, &args);
+    s_rng = 0x9E3779B97F4A7C15ull ^ args.seed;
+
+    static const int swarms[] = { 5, 10, 20, 50 };
+    printf("%-20s %12d genes, %d byte frame, migration every %d ms, %d%% loss, queue %d\n", "medium",
+           args.genes, (int)MIGRATION_FRAME_SIZE(args.genes, 0), args.interval_ms, args.loss_pct,
+           args.queue);
+
+    int failed = 0;
+    for (size_t s = 0; s < sizeof(swarms) / sizeof(swarms[0]); s++) {
+        int robots = swarms[s];
+        result_t uni, bc;
+        run(&args, robots, false, &uni);
+        run(&args, robots, true, &bc);
+
+        const result_t *results[] = { &uni, &bc };
+        const char *names[] = { "unicast", "broadcast" };
+        double ratio[2];
+        for (int m = 0; m < 2; m++) {
+            const result_t *r = results[m];
+            long pairs = r->migrations * (robots - 1);
+            ratio[m] = pairs > 0 ? (double)r->delivered / pairs : 0.0;
+            char name[32];
+            snprintf(name, sizeof(name), "%s/%d", names[m], robots);
+            printf("%-20s %12.2f ms airtime/migration, %5.1f tx/migration, %5.1f%% delivered, "
+                   "%5.1f%% of the channel, %ld refused\n", name,
+                   r->migrations ? r->airtime_us / r->migrations / 1000.0 : 0.0,
+                   r->migrations ? (double)r->transmissions / r->migrations : 0.0,
+                   100.0 * ratio[m], 100.0 * r->busy_us / r->elapsed_us, r->refused);
+        }
+
+        if (bc.transmissions > bc.migrations || bc.airtime_us >= uni.airtime_us) {
+            printf("broadcast FAILED: %ld transmissions for %ld migrations\n", bc.transmissions,
+                   bc.migrations);
+            failed = 1;
+        }
+        // A quiet channel: only the loss rate stands between a frame and a peer
+        double quiet = 1.0 - args.loss_pct / 100.0;
+        if (robots == swarms[0] && (ratio[0] < quiet - 0.05 || fabs(ratio[1] - quiet) > 0.05)) {
+            printf("delivery FAILED: %.3f unicast, %.3f broadcast, %.3f expected\n", ratio[0],
+                   ratio[1], quiet);
+            failed = 1;
+        }
+    }
+    return failed;
+}
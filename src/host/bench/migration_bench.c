@@ -0,0 +1,261 @@
+/* Migration frame round-trip benchmark for the host build.
+ *
+ * Encodes random best solutions as migration frames (migration_frame.h),
+ * raw and quantised, views them in place and decodes their genes, and
+ * times each step against the text out_message_t older firmware sends,
+ * which the receive path still accepts. Checks that raw genes and fitness
+ * come back bit-exact, quantised genes within half a code step, legacy
+ * genes within the three decimals they were printed with, and that no
+ * single bit flip, truncation or newer version of a frame is accepted.
+ *
+ * Exits non-zero on the first check that fails.
+ *
+ * Usage: migration_bench [--iterations N] [--seed S]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_now.h"
+#include "esp_random.h"
+#include "globals.h"
+#include "ga.h"
+#include "data_structures.h"
+#include "migration_frame.h"
+#include "bench_util.h"
+
+#define DEFAULT_ITERATIONS 100000
+#define DEFAULT_SEED       12345u
+#define GENE_MIN           -5.12f   // Rastrigin, the firmware default
+#define GENE_MAX           5.12f
+#define SAMPLE_FRAMES      64
+#define LEGACY_TOLERANCE   0.0006f  // "%.3f" rounding and float's own
+
+typedef struct {
+    int iterations;
+    uint32_t seed;
+} bench_args_t;
+
+typedef struct {
+    float fitness;
+    float genes[MAX_GENES];
+} migrant_t;
+
+static void parse_args(int argc, char **argv, bench_args_t *args)
+{
+    args->iterations = DEFAULT_ITERATIONS;
+    args->seed = DEFAULT_SEED;
+
+    for (int i = 1; i < argc; i++) {
+        if (bench_common_arg(argc, argv, &i, &args->iterations, &args->seed)) {
+            continue;
+        }
+        fprintf(stderr, "usage: %s [--iterations N] [--seed S]\n", argv[0]);
+        exit(2);
+    }
+    if (args->iterations < SAMPLE_FRAMES) args->iterations = SAMPLE_FRAMES;
+}
+
+static float random_gene(void)
+{
+    return GENE_MIN + (GENE_MAX - GENE_MIN) * (float)(esp_random() >> 8) / (float)(1u << 24);
+}
+
+// What espnow_push_best_solution() sent before the binary frame
+static size_t legacy_encode(uint8_t *buf, const migrant_t *m, uint32_t log_id)
+{
+    out_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.log_id = log_id;
+    snprintf(msg.robot_id, sizeof(msg.robot_id), "HOST");
+    int offset = snprintf(msg.message, sizeof(msg.message), "%.3f|", m->fitness);
+    for (int i = 0; i < MAX_GENES && offset < (int)sizeof(msg.message); i++) {
+        offset += snprintf(msg.message + offset, sizeof(msg.message) - offset, "%.3f|", m->genes[i]);
+    }
+    memcpy(buf, &msg, sizeof(msg));
+    return sizeof(msg);
+}
+
+static size_t frame_encode(uint8_t *buf, size_t cap, const migrant_t *m, uint16_t seq, bool quantised)
+{
+    migration_frame_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.seq = seq;
+    hdr.flags = quantised ? MIGRATION_FRAME_QUANTISED : 0;
+    memcpy(hdr.robot_id, "HOST", sizeof(hdr.robot_id));
+    hdr.log_id = seq;
+    hdr.fitness = m->fitness;
+    return migration_frame_encode(buf, cap, &hdr, m->genes, MAX_GENES, GENE_MIN, GENE_MAX);
+}
+
+// Largest gene error of a decoded frame, -1 if it did not decode
+static float check_round_trip(const uint8_t *frame, size_t len, const migrant_t *m, uint16_t seq)
+{
+    migration_frame_view_t view;
+    float genes[MAX_GENES];
+    if (migration_frame_view(frame, len, &view) != ESP_OK || strcmp(view.robot_id, "HOST") != 0 ||
+        migration_frame_genes(&view, genes, MAX_GENES) != MAX_GENES ||
+        (!view.legacy && (view.seq != seq || view.fitness != m->fitness)) ||
+        (view.legacy && fabsf(view.fitness - m->fitness) > LEGACY_TOLERANCE)) {
+        return -1.0f;
+    }
+    float err = 0.0f;
+    for (int i = 0; i < MAX_GENES; i++) {
+        float e = fabsf(genes[i] - m->genes[i]);
+        err = e > err ? e : err;
+    }
+    return err;
+}
+
+// Frames the decoder accepts after one bit flip or a truncation, 0 expected
+static int count_damaged_accepted(const uint8_t *frame, size_t len)
+{
+    uint8_t copy[ESP_NOW_MAX_DATA_LEN];
+    migration_frame_view_t view;
+    int accepted = 0;
+    for (size_t bit = 0; bit < len * 8; bit++) {
+        memcpy(copy, frame, len);
+        copy[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        accepted += migration_frame_view(copy, len, &view) == ESP_OK;
+    }
+    for (size_t cut = 1; cut < len; cut++) {
+        accepted += migration_frame_view(frame, cut, &view) == ESP_OK;
+    }
+    return accepted;
+}
+
+typedef struct {
+    const char *name;
+    bool quantised;
+    bool legacy;
+    float max_error;    // allowed per gene
+} wire_format_t;
+
+int main(int argc, char **argv)
+{
+    bench_args_t args;
+    parse_args(argc, argv, &args);
+    esp_log_level_set("*", ESP_LOG_ERROR);
+    host_esp_random_seed(args.seed);
+
+    // ga_gene_dequantise(), used for legacy quantised text, follows the
+    // current fitness function
+    if (init_ga(false) != ESP_OK || gene_min_value != GENE_MIN || gene_max_value != GENE_MAX) {
+        printf("init_ga failed or the default function is not over [%.2f, %.2f]\n", GENE_MIN, GENE_MAX);
+        return 1;
+    }
+
+    migrant_t *migrants = malloc(SAMPLE_FRAMES * sizeof(migrant_t));
+    if (migrants == NULL) {
+        return 1;
+    }
+    for (int s = 0; s < SAMPLE_FRAMES; s++) {
+        for (int i = 0; i < MAX_GENES; i++) {
+            migrants[s].genes[i] = random_gene();
+        }
+        migrants[s].fitness = ga_evaluate(migrants[s].genes);
+    }
+
+    const float half_step = (GENE_MAX - GENE_MIN) / (4.0f * GA_GENE_QMAX);
+    const wire_format_t formats[] = {
+        { "raw",       false, false, 0.0f },
+        { "quantised", true,  false, half_step * 1.001f },
+        { "legacy",    false, true,  LEGACY_TOLERANCE },
+    };
+
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        const wire_format_t *fmt = &formats[f];
+        uint8_t frames[SAMPLE_FRAMES][sizeof(out_message_t)];
+        size_t lens[SAMPLE_FRAMES];
+        char label[32];
+
+        double t0 = now_ns();
+        for (int i = 0; i < args.iterations; i++) {
+            int s = i % SAMPLE_FRAMES;
+            lens[s] = fmt->legacy ? legacy_encode(frames[s], &migrants[s], (uint32_t)i)
+                                  : frame_encode(frames[s], sizeof(frames[s]), &migrants[s], (uint16_t)s,
+                                                 fmt->quantised);
+        }
+        double encode_ns = (now_ns() - t0) / args.iterations;
+
+        migration_frame_view_t view;
+        float genes[MAX_GENES];
+        float acc = 0.0f;
+        t0 = now_ns();
+        for (int i = 0; i < args.iterations; i++) {
+            int s = i % SAMPLE_FRAMES;
+            migration_frame_view(frames[s], lens[s], &view);
+            acc += view.fitness;
+        }
+        double view_ns = (now_ns() - t0) / args.iterations;
+        t0 = now_ns();
+        for (int i = 0; i < args.iterations; i++) {
+            int s = i % SAMPLE_FRAMES;
+            migration_frame_view(frames[s], lens[s], &view);
+            migration_frame_genes(&view, genes, MAX_GENES);
+            acc += genes[0];
+        }
+        double decode_ns = (now_ns() - t0) / args.iterations;
+        bench_sink(acc);
+
+        float max_error = 0.0f;
+        for (int s = 0; s < SAMPLE_FRAMES; s++) {
+            float err = check_round_trip(frames[s], lens[s], &migrants[s], (uint16_t)s);
+            if (err < 0.0f || err > fmt->max_error) {
+                printf("%s round trip MISMATCH on frame %d: error %.6f\n", fmt->name, s, err);
+                return 1;
+            }
+            max_error = err > max_error ? err : max_error;
+        }
+        snprintf(label, sizeof(label), "wire/%s", fmt->name);
+        printf("%-20s %12u bytes, encode %.1f ns, view %.1f ns, view+genes %.1f ns, %.6f max gene error\n",
+               label, (unsigned)lens[0], encode_ns, view_ns, decode_ns, max_error);
+
+        if (!fmt->legacy) {
+            int accepted = count_damaged_accepted(frames[0], lens[0]);
+            if (accepted != 0) {
+                printf("%s: %d damaged frames ACCEPTED\n", fmt->name, accepted);
+                return 1;
+            }
+        }
+    }
+
+    // A newer frame version is refused rather than misread
+    uint8_t frame[MIGRATION_FRAME_SIZE(MAX_GENES, 0)];
+    size_t len = frame_encode(frame, sizeof(frame), &migrants[0], 0, false);
+    frame[offsetof(migration_frame_header_t, version)]++;
+    migration_frame_view_t view;
+    if (migration_frame_view(frame, len, &view) != ESP_ERR_INVALID_VERSION) {
+        printf("newer frame version not refused\n");
+        return 1;
+    }
+
+    // Text genes of a GA_QUANTISED_GENES robot before the binary frame,
+    // "fitness|Q" and four hex digits a code
+    out_message_t msg;
+    memset(&msg, 0, sizeof(msg));
+    snprintf(msg.robot_id, sizeof(msg.robot_id), "HOST");
+    int offset = snprintf(msg.message, sizeof(msg.message), "%.3f|Q", migrants[0].fitness);
+    for (int i = 0; i < MAX_GENES; i++) {
+        offset += snprintf(msg.message + offset, sizeof(msg.message) - offset, "%04x",
+                           (uint16_t)ga_gene_quantise(migrants[0].genes[i]));
+    }
+    float genes[MAX_GENES];
+    if (migration_frame_view((const uint8_t *)&msg, offsetof(out_message_t, message) + offset + 1, &view) != ESP_OK ||
+        !view.legacy || migration_frame_genes(&view, genes, MAX_GENES) != MAX_GENES) {
+        printf("legacy quantised text not accepted\n");
+        return 1;
+    }
+    for (int i = 0; i < MAX_GENES; i++) {
+        if (genes[i] != ga_gene_dequantise(ga_gene_quantise(migrants[0].genes[i]))) {
+            printf("legacy quantised gene %d MISMATCH: %.6f\n", i, genes[i]);
+            return 1;
+        }
+    }
+    printf("%-20s %12s\n", "wire/damaged", "rejected");
+
+    free(migrants);
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef HOST_CJSON_H
+#define HOST_CJSON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parsing is never reached on the host (https_get always fails), so the
+// shim only has to satisfy the linker.
+typedef struct cJSON {
+    int valueint;
+    double valuedouble;
+} cJSON;
+
+cJSON *cJSON_Parse(const char *value);
+void cJSON_Delete(cJSON *item);
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string);
+cJSON *cJSON_GetArrayItem(const cJSON *array, int index);
+int cJSON_GetArraySize(const cJSON *array);
+int cJSON_IsArray(const cJSON *item);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_CJSON_H
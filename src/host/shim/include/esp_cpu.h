@@ -0,0 +1,20 @@
+#ifndef HOST_ESP_CPU_H
+#define HOST_ESP_CPU_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+// Nanoseconds from CLOCK_MONOTONIC, wrapping like the 32-bit CCOUNT
+// register: the host counts as a 1 GHz core.
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_ESP_CPU_H
@@ -0,0 +1,18 @@
+#ifndef HOST_ESP_CRC_H
+#define HOST_ESP_CRC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3, reflected) as the ROM computes it: esp_crc32_le(0, ...)
+// equals zlib's crc32() of the same bytes.
+uint32_t esp_crc32_le(uint32_t crc, uint8_t const *buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_ESP_CRC_H
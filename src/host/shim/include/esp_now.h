@@ -0,0 +1,37 @@
+#ifndef HOST_ESP_NOW_H
+#define HOST_ESP_NOW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+
+#define ESP_NOW_ETH_ALEN     6
+#define ESP_NOW_MAX_DATA_LEN 250
+
+typedef enum {
+    ESP_NOW_SEND_SUCCESS = 0,
+    ESP_NOW_SEND_FAIL,
+} esp_now_send_status_t;
+
+typedef struct {
+    signed rssi:8;
+} wifi_pkt_rx_ctrl_t;
+
+typedef struct {
+    uint8_t *src_addr;
+    uint8_t *des_addr;
+    wifi_pkt_rx_ctrl_t *rx_ctrl;
+} esp_now_recv_info_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_ESP_NOW_H
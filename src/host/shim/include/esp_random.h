@@ -0,0 +1,18 @@
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Deterministic stand-in for the hardware RNG so host runs are repeatable.
+uint32_t esp_random(void);
+void host_esp_random_seed(uint32_t seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_ESP_RANDOM_H
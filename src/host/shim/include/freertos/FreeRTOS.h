@@ -0,0 +1,50 @@
+/* Host shim for FreeRTOS.
+ *
+ * Only the subset of the FreeRTOS API used by the components built on the
+ * host is provided. Handles are opaque pointers, ticks are milliseconds.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef int32_t  BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t EventBits_t;
+
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef void *EventGroupHandle_t;
+typedef void *QueueSetHandle_t;
+typedef void *QueueSetMemberHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE  ((BaseType_t)1)
+#define pdFAIL  pdFALSE
+#define pdPASS  pdTRUE
+
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS  ((TickType_t)1)
+#define configTICK_RATE_HZ  1000
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+#define BIT0  0x00000001
+#define BIT1  0x00000002
+#define BIT2  0x00000004
+#define BIT3  0x00000008
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_FREERTOS_H
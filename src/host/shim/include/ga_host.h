@@ -0,0 +1,24 @@
+#ifndef GA_HOST_H
+#define GA_HOST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+// Counters maintained by the host stand-ins for the ESP-NOW hooks.
+extern uint32_t host_migrations_pushed;
+extern uint32_t host_drain_calls;
+extern volatile uint32_t host_log_entries;
+extern uint32_t host_checkpoints_stored;   // ga_checkpoint_store() calls
+
+// Create LogQueue/LogBodyQueue/logCounterMutex and a task that empties the
+// queues, so ga_task can run on the host.
+void host_ga_logging_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GA_HOST_H
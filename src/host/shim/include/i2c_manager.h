@@ -0,0 +1,7 @@
+#ifndef HOST_I2C_MANAGER_H
+#define HOST_I2C_MANAGER_H
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+#endif // HOST_I2C_MANAGER_H
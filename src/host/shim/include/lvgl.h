@@ -0,0 +1,6 @@
+#ifndef HOST_LVGL_H
+#define HOST_LVGL_H
+
+typedef struct _lv_obj_t lv_obj_t;
+
+#endif // HOST_LVGL_H
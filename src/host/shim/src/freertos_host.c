@@ -0,0 +1,418 @@
+/* Host implementation of the FreeRTOS subset declared in shim/include.
+ *
+ * Tasks are detached pthreads, queues are bounded ring buffers guarded by a
+ * mutex and two condition variables, event groups are a bit mask plus a
+ * condition variable, as is each task's notification count. Core affinity
+ * and priorities are ignored.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+} host_queue_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    EventBits_t bits;
+} host_event_group_t;
+
+typedef struct {
+    TaskFunction_t fn;
+    void *params;
+} host_task_start_t;
+
+static void deadline_from_ticks(struct timespec *ts, TickType_t ticks)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+// Wait on cond until woken or the tick budget runs out. Returns false on timeout.
+static bool wait_ticks(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    struct timespec ts;
+    deadline_from_ticks(&ts, ticks);
+    return pthread_cond_timedwait(cond, lock, &ts) != ETIMEDOUT;
+}
+
+/* ---------------------------------------------------------------- tasks -- */
+
+static void *task_trampoline(void *arg)
+{
+    host_task_start_t start = *(host_task_start_t *)arg;
+    free(arg);
+    start.fn(start.params);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *params, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core_id)
+{
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    (void)core_id;
+
+    host_task_start_t *start = malloc(sizeof(*start));
+    if (start == NULL) {
+        return pdFAIL;
+    }
+    start->fn = fn;
+    start->params = params;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_trampoline, start) != 0) {
+        free(start);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (handle) {
+        *handle = (TaskHandle_t)(uintptr_t)thread;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *params, UBaseType_t priority, TaskHandle_t *handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, params, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    // Only self-deletion is supported, which is the only form the firmware uses
+    // from inside its own task functions.
+    if (task == NULL) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {
+        .tv_sec = ticks / 1000,
+        .tv_nsec = (long)(ticks % 1000) * 1000000L,
+    };
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000L);
+}
+
+void host_task_yield(void)
+{
+    sched_yield();
+}
+
+/* -------------------------------------------------------- notifications -- */
+
+// A task gets a notification count the first time it is given or takes
+// one, found again by its handle. Slots are never reused.
+#define HOST_NOTIFY_SLOTS 32
+
+typedef struct {
+    TaskHandle_t task;
+    uint32_t count;
+    pthread_cond_t given;
+} host_notify_t;
+
+static host_notify_t s_notify[HOST_NOTIFY_SLOTS];
+static pthread_mutex_t s_notify_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Called with s_notify_lock held
+static host_notify_t *notify_slot(TaskHandle_t task)
+{
+    for (int i = 0; i < HOST_NOTIFY_SLOTS; i++) {
+        if (s_notify[i].task == task) {
+            return &s_notify[i];
+        }
+    }
+    for (int i = 0; i < HOST_NOTIFY_SLOTS; i++) {
+        if (s_notify[i].task == NULL) {
+            s_notify[i].task = task;
+            s_notify[i].count = 0;
+            pthread_cond_init(&s_notify[i].given, NULL);
+            return &s_notify[i];
+        }
+    }
+    abort();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return (TaskHandle_t)(uintptr_t)pthread_self();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&s_notify_lock);
+    host_notify_t *n = notify_slot(task);
+    n->count++;
+    pthread_cond_signal(&n->given);
+    pthread_mutex_unlock(&s_notify_lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    pthread_mutex_lock(&s_notify_lock);
+    host_notify_t *n = notify_slot(xTaskGetCurrentTaskHandle());
+    while (n->count == 0) {
+        if (!wait_ticks(&n->given, &s_notify_lock, ticks)) {
+            break;
+        }
+    }
+    uint32_t value = n->count;
+    if (value > 0) {
+        n->count = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&s_notify_lock);
+    return value;
+}
+
+/* --------------------------------------------------------------- queues -- */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    host_queue_t *q = calloc(1, sizeof(*q));
+    if (q == NULL) {
+        return NULL;
+    }
+    q->storage = malloc((size_t)length * item_size);
+    if (q->storage == NULL) {
+        free(q);
+        return NULL;
+    }
+    q->length = length;
+    q->item_size = item_size;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    return q;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    host_queue_t *q = queue;
+    if (q == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->storage);
+    free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    host_queue_t *q = queue;
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (!wait_ticks(&q->not_full, &q->lock, ticks)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFAIL;
+        }
+    }
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(q->storage + (size_t)tail * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    host_queue_t *q = queue;
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (!wait_ticks(&q->not_full, &q->lock, ticks)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFAIL;
+        }
+    }
+    q->head = (q->head + q->length - 1) % q->length;
+    memcpy(q->storage + (size_t)q->head * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    host_queue_t *q = queue;
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (!wait_ticks(&q->not_empty, &q->lock, ticks)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFAIL;
+        }
+    }
+    memcpy(item, q->storage + (size_t)q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    host_queue_t *q = queue;
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t count = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return count;
+}
+
+/* ----------------------------------------------------------- semaphores -- */
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    pthread_mutex_t *m = malloc(sizeof(*m));
+    if (m) {
+        pthread_mutex_init(m, NULL);
+    }
+    return m;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    if (sem == NULL) {
+        return pdFAIL;
+    }
+    if (ticks == portMAX_DELAY) {
+        return pthread_mutex_lock(sem) == 0 ? pdPASS : pdFAIL;
+    }
+    struct timespec ts;
+    deadline_from_ticks(&ts, ticks);
+    return pthread_mutex_timedlock(sem, &ts) == 0 ? pdPASS : pdFAIL;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    if (sem == NULL) {
+        return pdFAIL;
+    }
+    return pthread_mutex_unlock(sem) == 0 ? pdPASS : pdFAIL;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem) {
+        pthread_mutex_destroy(sem);
+        free(sem);
+    }
+}
+
+/* --------------------------------------------------------- event groups -- */
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    host_event_group_t *g = calloc(1, sizeof(*g));
+    if (g) {
+        pthread_mutex_init(&g->lock, NULL);
+        pthread_cond_init(&g->changed, NULL);
+    }
+    return g;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    host_event_group_t *g = group;
+    if (g) {
+        pthread_mutex_destroy(&g->lock);
+        pthread_cond_destroy(&g->changed);
+        free(g);
+    }
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    host_event_group_t *g = group;
+    pthread_mutex_lock(&g->lock);
+    g->bits |= bits;
+    EventBits_t now = g->bits;
+    pthread_cond_broadcast(&g->changed);
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    host_event_group_t *g = group;
+    pthread_mutex_lock(&g->lock);
+    EventBits_t before = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    host_event_group_t *g = group;
+    pthread_mutex_lock(&g->lock);
+    EventBits_t now = g->bits;
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks)
+{
+    host_event_group_t *g = group;
+    pthread_mutex_lock(&g->lock);
+    for (;;) {
+        EventBits_t hit = g->bits & bits;
+        if (wait_for_all ? (hit == bits) : (hit != 0)) {
+            break;
+        }
+        if (!wait_ticks(&g->changed, &g->lock, ticks)) {
+            break;
+        }
+    }
+    EventBits_t now = g->bits;
+    if (clear_on_exit && (wait_for_all ? ((now & bits) == bits) : ((now & bits) != 0))) {
+        g->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&g->lock);
+    return now;
+}
@@ -0,0 +1,50 @@
+/* Host stand-in for ga_checkpoint.c: the checkpoint "partition" is one
+ * heap copy of the last blob stored, so a bench can save, re-init and
+ * resume within one process.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_heap_caps.h"
+#include "ga_checkpoint.h"
+#include "ga_host.h"
+
+static void *s_blob = NULL;
+static size_t s_blob_len = 0;
+uint32_t host_checkpoints_stored = 0;
+
+esp_err_t ga_checkpoint_store(const void *data, size_t len)
+{
+    void *blob = malloc(len);
+    if (blob == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(blob, data, len);
+    free(s_blob);
+    s_blob = blob;
+    s_blob_len = len;
+    host_checkpoints_stored++;
+    return ESP_OK;
+}
+
+esp_err_t ga_checkpoint_load(void **data, size_t *len)
+{
+    if (s_blob == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *data = heap_caps_malloc(s_blob_len, MALLOC_CAP_DEFAULT);
+    if (*data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(*data, s_blob, s_blob_len);
+    *len = s_blob_len;
+    return ESP_OK;
+}
+
+esp_err_t ga_checkpoint_erase(void)
+{
+    free(s_blob);
+    s_blob = NULL;
+    s_blob_len = 0;
+    return ESP_OK;
+}
@@ -0,0 +1,94 @@
+/* Definitions the GA normally gets from main/swarmcom.cpp, espnow_main.c,
+ * https.c and the json component. On the host nothing is radioed or logged
+ * to SD: the hooks only count what the GA pushed so benches can report it.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "cJSON.h"
+#include "https.h"
+#include "globals.h"
+#include "data_structures.h"
+#include "data_logging.h"
+#include "ga_host.h"
+
+// Logging
+uint32_t log_counter = 0;
+QueueHandle_t LogQueue = NULL;
+QueueHandle_t LogBodyQueue = NULL;
+QueueHandle_t ga_buffer_queue = NULL;
+SemaphoreHandle_t logCounterMutex = NULL;
+
+// GA
+EventGroupHandle_t ga_event_group = NULL;
+
+// IDs
+char *robot_id = "HOST";
+
+// EMBED_TXTFILES symbols for the QRNG certificate
+const uint8_t qrng_anu_ca_crt_start[1] asm("_binary_qrng_anu_ca_pem_start") = {0};
+const uint8_t qrng_anu_ca_crt_end[1] asm("_binary_qrng_anu_ca_pem_end") = {0};
+
+uint32_t host_migrations_pushed = 0;
+uint32_t host_drain_calls = 0;
+volatile uint32_t host_log_entries = 0;
+
+// Stand-in for write_task: empty both log queues so the GA never blocks.
+static void host_log_drain_task(void *arg)
+{
+    (void)arg;
+    event_log_t log_entry;
+    event_log_message_t log_body;
+    for (;;) {
+        while (xQueueReceive(LogQueue, &log_entry, 0) == pdTRUE) host_log_entries++;
+        while (xQueueReceive(LogBodyQueue, &log_body, 0) == pdTRUE) host_log_entries++;
+        vTaskDelay(1);
+    }
+}
+
+void host_ga_logging_start(void)
+{
+    if (LogQueue != NULL) {
+        return;
+    }
+    logCounterMutex = xSemaphoreCreateMutex();
+    LogQueue = xQueueCreate(LOG_Q_LEN, sizeof(event_log_t));
+    LogBodyQueue = xQueueCreate(LOG_BODY_Q_LEN, sizeof(event_log_message_t));
+    xTaskCreate(host_log_drain_task, "log drain", 4096, NULL, 1, NULL);
+}
+
+void espnow_push_best_solution(float current_best_fitness, const float *best_solution,
+    size_t gene_count, uint32_t log_id, time_t created_datetime)
+{
+    (void)current_best_fitness;
+    (void)best_solution;
+    (void)gene_count;
+    (void)log_id;
+    (void)created_datetime;
+    host_migrations_pushed++;
+}
+
+void drain_buffered_messages(void)
+{
+    host_drain_calls++;
+}
+
+esp_err_t https_get(const char *url, http_response_t *response, const uint8_t *cert)
+{
+    (void)url;
+    (void)cert;
+    response->data = NULL;
+    response->len = 0;
+    return ESP_FAIL;
+}
+
+cJSON *cJSON_Parse(const char *value) { (void)value; return NULL; }
+void cJSON_Delete(cJSON *item) { (void)item; }
+cJSON *cJSON_GetObjectItem(const cJSON *object, const char *string) { (void)object; (void)string; return NULL; }
+cJSON *cJSON_GetArrayItem(const cJSON *array, int index) { (void)array; (void)index; return NULL; }
+int cJSON_GetArraySize(const cJSON *array) { (void)array; return 0; }
+int cJSON_IsArray(const cJSON *item) { (void)item; return 0; }
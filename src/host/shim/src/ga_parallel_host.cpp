@@ -0,0 +1,108 @@
+// Host implementation of ga_parallel.h: the core 0 helper task becomes a
+// std::thread. Same contract as ga_parallel.c, so ga.c runs unchanged.
+
+#include "ga_parallel.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+namespace {
+
+// Spin this many times before blocking, only when a second CPU is there
+// to run the other side. Keeps the barrier cost near the ESP32 notify
+// latency instead of a futex round trip.
+constexpr int kSpinLimit = 20000;
+
+struct Helper {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<unsigned> posted{0};    // jobs handed to the helper
+    std::atomic<unsigned> finished{0};  // jobs it has completed
+    ga_parallel_fn_t fn = nullptr;
+    void *arg = nullptr;
+    bool spin = false;
+    bool running = false;
+};
+
+// Never destroyed: the detached thread may still be waiting on the
+// condition variable when the process exits.
+Helper &s_helper = *new Helper;
+
+template <typename Ready>
+void wait_for(Ready ready)
+{
+    if (s_helper.spin) {
+        for (int i = 0; i < kSpinLimit; i++) {
+            if (ready()) {
+                return;
+            }
+        }
+    }
+    std::unique_lock<std::mutex> lock(s_helper.mutex);
+    s_helper.cv.wait(lock, ready);
+}
+
+void notify()
+{
+    // Taking the lock orders the store against a waiter that is between
+    // its predicate check and cv.wait().
+    { std::lock_guard<std::mutex> lock(s_helper.mutex); }
+    s_helper.cv.notify_all();
+}
+
+void helper_main()
+{
+    unsigned seen = 0;
+    for (;;) {
+        wait_for([&] { return s_helper.posted.load(std::memory_order_acquire) != seen; });
+        seen++;
+        s_helper.fn(s_helper.arg, 1);
+        s_helper.finished.store(seen, std::memory_order_release);
+        notify();
+    }
+}
+
+} // namespace
+
+extern "C" esp_err_t ga_parallel_start(void)
+{
+    if (s_helper.running) {
+        return ESP_OK;
+    }
+    s_helper.spin = std::thread::hardware_concurrency() > 1;
+    try {
+        // Detached like a FreeRTOS task, it lives until the process exits
+        std::thread(helper_main).detach();
+    } catch (const std::system_error &) {
+        return ESP_FAIL;
+    }
+    s_helper.running = true;
+    return ESP_OK;
+}
+
+extern "C" bool ga_parallel_active(void)
+{
+    return s_helper.running;
+}
+
+extern "C" void ga_parallel_run(ga_parallel_fn_t fn, void *arg)
+{
+    if (!s_helper.running) {
+        fn(arg, 0);
+        fn(arg, 1);
+        return;
+    }
+
+    s_helper.fn = fn;
+    s_helper.arg = arg;
+    unsigned job = s_helper.posted.load(std::memory_order_relaxed) + 1;
+    s_helper.posted.store(job, std::memory_order_release);
+    notify();
+
+    fn(arg, 0);
+
+    wait_for([&] { return s_helper.finished.load(std::memory_order_acquire) == job; });
+}
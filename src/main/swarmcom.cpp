@@ -118,6 +118,13 @@ void app_main() {
     }
     ESP_ERROR_CHECK(ret);
 
+    //A brown-out cut the last experiment short, carry its GA on from the
+    //last checkpoint rather than a fresh population
+    if (esp_reset_reason() == ESP_RST_BROWNOUT) {
+        ESP_LOGW(TAG, "Brown-out reset, resuming the GA from its checkpoint");
+        g_ga_resume = true;
+    }
+
     size_t free_heap_size = esp_get_free_heap_size();
     ESP_LOGI(TAG, "Heap when starting: %u", free_heap_size);
     
@@ -230,7 +237,7 @@ void app_main() {
 
         //Initialize Genetic Algorithm
         //TODO: running false as request is limited to 1 per minute
-        init_ga(false);
+        ESP_ERROR_CHECK(init_ga(false));
 
         free_heap_size = esp_get_free_heap_size();
         ESP_LOGI("Check", "Free heap after init_ga: %u", free_heap_size);
@@ -253,14 +260,13 @@ void app_main() {
         free_heap_size = esp_get_free_heap_size();
         ESP_LOGI(TAG, "Current free heap size: %u bytes", free_heap_size);
 
-        //Genetic Algorithm task and pin it to core 1
+        //Genetic Algorithm worker, pinned to core 1, and first run
         ga_event_group = xEventGroupCreate();
-        xTaskCreatePinnedToCore(ga_task,"GA Task",8192,NULL,3,&ga_task_handle,1);
+        ESP_ERROR_CHECK(ga_worker_start());
+        ga_request_run();
         //Experiment length
         vTaskDelay(pdMS_TO_TICKS(DEFAULT_EXPERIMENT_DURATION * 1000));
-        example_espnow_event_t stop_evt = {};
-        stop_evt.id = EXAMPLE_ESPNOW_STOP;
-        xQueueSend(s_example_espnow_queue, &stop_evt, portMAX_DELAY);
+        espnow_request_stop();
         xEventGroupWaitBits(
             s_espnow_event_group,
             ESPNOW_COMPLETED_BIT,  /* bits to wait for            */
@@ -337,7 +343,7 @@ void app_main() {
         ESP_LOGI(TAG, "Wi-Fi unavailable. Proceeding offline.");
     
         // Initialize Genetic Algorithm
-        init_ga(false);
+        ESP_ERROR_CHECK(init_ga(false));
     
         // Run experiment as before
         RTC_GetDate(&global_date);
@@ -352,24 +358,23 @@ void app_main() {
         experiment_start = convert_to_time_t(&global_date, &global_time);
         i2c_pololu_command(DEFAULT_ROBOT_SPEED);
     
-        // Genetic Algorithm task
+        // Genetic Algorithm worker and first run
         ga_event_group = xEventGroupCreate();
-        xTaskCreatePinnedToCore(ga_task,"GA Task",8192,NULL,3,&ga_task_handle,1);
+        ESP_ERROR_CHECK(ga_worker_start());
+        ga_request_run();
         
         vTaskDelay(pdMS_TO_TICKS(15000));
-        example_espnow_event_t stop_evt = {};
-        stop_evt.id = EXAMPLE_ESPNOW_STOP;
-        xQueueSend(s_example_espnow_queue, &stop_evt, portMAX_DELAY);
+        // ESP-NOW never started offline, so stop the GA worker directly
+        // rather than through espnow_task
+        ga_request_stop();
         xEventGroupWaitBits(
-            s_espnow_event_group,
-            ESPNOW_COMPLETED_BIT,  /* bits to wait for            */
-            pdTRUE,                /* clear the bit on exit       */
+            ga_event_group,
+            GA_STOPPED_BIT,        /* bits to wait for            */
+            pdFALSE,               /* leave it set                */
             pdTRUE,                /* wait for *all* bits (just 1)*/
-            portMAX_DELAY);      
+            portMAX_DELAY);
         vTaskDelay(pdMS_TO_TICKS(200)); 
 
-        espnow_deinit_all();
-        
         //skip upload_all_sd_files since no WiFi
         experiment_ended = true;
         RTC_GetTime(&global_time);